@@ -0,0 +1,39 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#define _GNU_SOURCE
+#define MEMPLUS_IMPLEMENTATION
+#include "../memplus.h"
+
+#include <stdio.h>
+#include <time.h>
+
+/* Keeps the compiler from hoisting or removing the measured work out of a loop. */
+#define barrier() __asm__ volatile("" ::: "memory")
+
+static inline double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+/* Prints the time taken since `start` for `amount` operations. */
+#define report(name, start, amount)                                                                \
+    do {                                                                                           \
+        double seconds_ = now() - (start);                                                         \
+        printf("  %-36s %9.2f ms %9.2f ns/op\n",                                                   \
+               name,                                                                               \
+               seconds_ * 1e3,                                                                     \
+               seconds_ * 1e9 / (double) (amount));                                                \
+    } while (0)
+
+/* Deterministic generator so every run measures the same data. */
+static uint64_t bench_seed = 0x9E3779B97F4A7C15ull;
+static inline uint64_t rand64(void) {
+    bench_seed ^= bench_seed << 13;
+    bench_seed ^= bench_seed >> 7;
+    bench_seed ^= bench_seed << 17;
+    return bench_seed;
+}
+
+#endif /* ifndef BENCH_H */
@@ -0,0 +1,33 @@
+#!/usr/bin/env bash
+
+BENCHES=(sort soa bitset interner file read_files string format thread_heap snapshot)
+
+cd `dirname $0`
+
+WHITE="\033[1;38m"
+RESET="\033[0m"
+
+run () {
+    if [[ -r ${1}.c ]]; then
+        echo -ne $WHITE
+        echo "|=> $1"
+        echo -ne $RESET
+        cc -O2 -pthread -o $1 ${1}.c
+        ./$1
+        rm -f $1
+        echo -ne $WHITE
+        echo "####################"
+        echo -ne $RESET
+    else
+        echo "No such file ${1}.c"
+        exit 1
+    fi
+}
+
+if [[ $# -gt 0 ]]; then
+    run $1
+else
+    for bench in ${BENCHES[@]}; do
+        run $bench
+    done
+fi
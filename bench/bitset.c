@@ -0,0 +1,88 @@
+#include "bench.h"
+
+#define BITS   (1 << 20)
+#define ROUNDS 200
+
+int main(void) {
+    mp_Allocator heap = mp_heap_allocator();
+
+    // The same sets as bitsets and as one bool per item, about 1% of the items are set
+    mp_Bitset a, b;
+    mp_bitset_init(&a, &heap);
+    mp_bitset_init(&b, &heap);
+    mp_bitset_resize(&a, BITS);
+    mp_bitset_resize(&b, BITS);
+    bool *bools_a = calloc(BITS, 1);
+    bool *bools_b = calloc(BITS, 1);
+    for (size_t i = 0; i < BITS; ++i) {
+        if (rand64() % 100 == 0) {
+            mp_bitset_set(&a, i);
+            bools_a[i] = true;
+        }
+        if (rand64() % 2 == 0) {
+            mp_bitset_set(&b, i);
+            bools_b[i] = true;
+        }
+    }
+    printf("  %d items, %zu bytes as bools, %zu bytes as bits\n",
+           BITS,
+           (size_t) BITS,
+           a.len * sizeof(uint64_t));
+
+    volatile size_t sink;
+    double          start = now();
+    for (int round = 0; round < ROUNDS; ++round) {
+        for (size_t i = 0; i < BITS; ++i)
+            bools_a[i] = bools_a[i] && bools_b[i];
+        barrier();
+    }
+    report("and, bools", start, (size_t) BITS * ROUNDS);
+    start = now();
+    for (int round = 0; round < ROUNDS; ++round) {
+        mp_bitset_and(&a, &b);
+        barrier();
+    }
+    report("and, mp_bitset_and", start, (size_t) BITS * ROUNDS);
+
+    start = now();
+    for (int round = 0; round < ROUNDS; ++round) {
+        size_t count = 0;
+        for (size_t i = 0; i < BITS; ++i)
+            count += bools_b[i];
+        sink = count;
+        barrier();
+    }
+    report("count, bools", start, (size_t) BITS * ROUNDS);
+    start = now();
+    for (int round = 0; round < ROUNDS; ++round) {
+        sink = mp_bitset_count(&b);
+        barrier();
+    }
+    report("count, mp_bitset_count", start, (size_t) BITS * ROUNDS);
+
+    start = now();
+    for (int round = 0; round < ROUNDS; ++round) {
+        size_t sum = 0;
+        for (size_t i = 0; i < BITS; ++i)
+            if (bools_a[i]) sum += i;
+        sink = sum;
+        barrier();
+    }
+    report("iterate set items, bools", start, (size_t) BITS * ROUNDS);
+    start = now();
+    for (int round = 0; round < ROUNDS; ++round) {
+        size_t sum = 0;
+        for (size_t i = mp_bitset_find_next(&a, 0); i < a.bits; i = mp_bitset_find_next(&a, i + 1))
+            sum += i;
+        sink = sum;
+        barrier();
+    }
+    report("iterate set items, find_next", start, (size_t) BITS * ROUNDS);
+    (void) sink;
+
+    mp_bitset_destroy(&a);
+    mp_bitset_destroy(&b);
+    free(bools_a);
+    free(bools_b);
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include "bench.h"
+
+#define FILE_PATH "bench_file.txt"
+#define LINES     (1 << 21)
+#define ROUNDS    10
+
+// Reads every byte so mapped pages are faulted in like read data is copied
+static size_t count_lines(const char *data, size_t len) {
+    size_t      count = 0;
+    const char *end   = data + len;
+    while ((data = memchr(data, '\n', end - data)) != NULL) {
+        ++data;
+        ++count;
+    }
+    return count;
+}
+
+int main(void) {
+    mp_Allocator heap = mp_heap_allocator();
+
+    FILE *file = fopen(FILE_PATH, "wb");
+    for (size_t i = 0; i < LINES; ++i)
+        fprintf(file, "%zu,record %zu,%zu\n", i, (size_t) rand64() % 100000, (size_t) rand64());
+    fclose(file);
+    mp_String content;
+    mp_read_entire_file(&heap, &content, FILE_PATH);
+    printf("  %d lines, %zu bytes, file in the page cache\n", LINES, content.len);
+    mp_string_destroy(&heap, &content);
+
+    volatile size_t sink;
+    double          start = now();
+    for (int round = 0; round < ROUNDS; ++round) {
+        mp_read_entire_file(&heap, &content, FILE_PATH);
+        sink = count_lines(content.cstr, content.len);
+        mp_string_destroy(&heap, &content);
+    }
+    report("mp_read_entire_file", start, (size_t) LINES * ROUNDS);
+
+    start = now();
+    for (int round = 0; round < ROUNDS; ++round) {
+        mp_Slice map;
+        mp_map_file(&map, FILE_PATH, MP_MAP_SEQUENTIAL);
+        sink = count_lines(map.ptr, map.len);
+        mp_unmap_file(&map);
+    }
+    report("mp_map_file", start, (size_t) LINES * ROUNDS);
+
+    start = now();
+    for (int round = 0; round < ROUNDS; ++round) {
+        FILE   *stream = fopen(FILE_PATH, "rb");
+        char   *line   = NULL;
+        size_t  cap    = 0;
+        size_t  count  = 0;
+        ssize_t len;
+        while ((len = getline(&line, &cap, stream)) >= 0)
+            count += len > 0;
+        sink = count;
+        free(line);
+        fclose(stream);
+    }
+    report("lines, getline", start, (size_t) LINES * ROUNDS);
+
+    start = now();
+    for (int round = 0; round < ROUNDS; ++round) {
+        mp_FileReader reader;
+        mp_Slice      line;
+        size_t        count = 0;
+        mp_file_reader_open(&reader, &heap, FILE_PATH, 0);
+        while (mp_file_reader_next_line(&reader, &line))
+            count += line.len > 0;
+        sink = count;
+        mp_file_reader_close(&reader);
+    }
+    report("lines, mp_file_reader_next_line", start, (size_t) LINES * ROUNDS);
+    (void) sink;
+
+    remove(FILE_PATH);
+    return 0;
+}
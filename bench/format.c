@@ -0,0 +1,82 @@
+#include "bench.h"
+
+#define ROUNDS 2000000
+
+// What mp_string_newf did before the fast path: vsnprintf to count, then to format
+static mp_String newf_vsnprintf(const mp_Allocator *allocator, const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    int len = vsnprintf(NULL, 0, fmt, args);
+    va_end(args);
+    char *cstr = mp_alloc(allocator, len + 1);
+    va_start(args, fmt);
+    vsnprintf(cstr, len + 1, fmt, args);
+    va_end(args);
+    return (mp_String){ len, cstr };
+}
+
+int main(void) {
+    // Reset often, so the arena stays in the cache and only formatting is measured
+    mp_SArena arena;
+    mp_sarena_init(&arena, 8 * 1024);
+    mp_Allocator alloc = mp_sarena_allocator(&arena);
+    printf("  %d rounds\n", ROUNDS);
+
+    volatile size_t sink;
+    double          start = now();
+    for (int i = 0; i < ROUNDS; ++i) {
+        mp_String str = newf_vsnprintf(&alloc,
+                                       "[%s] %s:%d request %zu took %d us",
+                                       "INFO",
+                                       "server.c",
+                                       i & 1023,
+                                       (size_t) i,
+                                       i % 977);
+        sink = str.len;
+        if ((i & 255) == 0) mp_sarena_reset(&arena);
+    }
+    report("log line, vsnprintf twice", start, ROUNDS);
+    start = now();
+    for (int i = 0; i < ROUNDS; ++i) {
+        mp_String str = mp_string_newf(&alloc,
+                                       "[%s] %s:%d request %zu took %d us",
+                                       "INFO",
+                                       "server.c",
+                                       i & 1023,
+                                       (size_t) i,
+                                       i % 977);
+        sink = str.len;
+        if ((i & 255) == 0) mp_sarena_reset(&arena);
+    }
+    report("log line, mp_string_newf", start, ROUNDS);
+
+    char buf[64];
+    start = now();
+    for (int i = 0; i < ROUNDS; ++i)
+        sink = snprintf(buf, sizeof(buf), "%llu", (unsigned long long) i * 2654435761u);
+    report("integer, snprintf %llu", start, ROUNDS);
+    start = now();
+    for (int i = 0; i < ROUNDS; ++i)
+        sink = mp_format_uint(buf, (unsigned long long) i * 2654435761u);
+    report("integer, mp_format_uint", start, ROUNDS);
+
+    // %.17g always round-trips, mp_format_double gives the shortest string that does
+    double value = 0.1;
+    start        = now();
+    for (int i = 0; i < ROUNDS; ++i) {
+        sink  = snprintf(buf, sizeof(buf), "%.17g", value);
+        value = value * 1.0000001 + 1e-3;
+    }
+    report("double, snprintf %.17g", start, ROUNDS);
+    value = 0.1;
+    start = now();
+    for (int i = 0; i < ROUNDS; ++i) {
+        sink  = mp_format_double(buf, value);
+        value = value * 1.0000001 + 1e-3;
+    }
+    report("double, mp_format_double", start, ROUNDS);
+    (void) sink;
+
+    mp_sarena_destroy(&arena);
+    return 0;
+}
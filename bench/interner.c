@@ -0,0 +1,60 @@
+#include "bench.h"
+
+#define WORDS  50000
+#define TOKENS (1 << 20)
+
+int main(void) {
+    mp_Allocator heap = mp_heap_allocator();
+
+    // A token stream that repeats a vocabulary of words, like identifiers in source code
+    static char words[WORDS][24];
+    static mp_Slice tokens[TOKENS];
+    for (size_t i = 0; i < WORDS; ++i)
+        snprintf(words[i], sizeof(words[i]), "identifier_%zu", (size_t) rand64() % 1000000);
+    for (size_t i = 0; i < TOKENS; ++i)
+        tokens[i] = mp_slice_from_cstr(words[rand64() % WORDS]);
+    printf("  %d tokens from %d words\n", TOKENS, WORDS);
+
+    static mp_String copies[TOKENS];
+    double           start = now();
+    for (size_t i = 0; i < TOKENS; ++i)
+        copies[i] = mp_string_new(&heap, tokens[i].ptr);
+    report("copy each token, mp_string_new", start, TOKENS);
+
+    static mp_String interned[TOKENS];
+    mp_Interner      interner;
+    mp_interner_init(&interner, &heap);
+    start = now();
+    for (size_t i = 0; i < TOKENS; ++i)
+        interned[i] = mp_interner_intern(&interner, tokens[i]);
+    report("mp_interner_intern", start, TOKENS);
+
+    mp_SharedInterner shared;
+    mp_shared_interner_init(&shared, &heap);
+    start = now();
+    for (size_t i = 0; i < TOKENS; ++i)
+        interned[i] = mp_shared_interner_intern(&shared, tokens[i]);
+    report("mp_shared_interner_intern", start, TOKENS);
+
+    // Compares every token with the next one
+    volatile size_t sink;
+    size_t          equal = 0;
+    start                 = now();
+    for (size_t i = 0; i + 1 < TOKENS; ++i)
+        equal += strcmp(copies[i].cstr, copies[i + 1].cstr) == 0;
+    sink = equal;
+    report("equality, strcmp", start, TOKENS);
+    equal = 0;
+    start = now();
+    for (size_t i = 0; i + 1 < TOKENS; ++i)
+        equal += interned[i].cstr == interned[i + 1].cstr;
+    sink = equal;
+    report("equality, interned pointers", start, TOKENS);
+    (void) sink;
+
+    for (size_t i = 0; i < TOKENS; ++i)
+        mp_string_destroy(&heap, &copies[i]);
+    mp_interner_destroy(&interner);
+    mp_shared_interner_destroy(&shared);
+    return 0;
+}
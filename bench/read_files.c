@@ -0,0 +1,62 @@
+#include "bench.h"
+
+#include <sys/stat.h>
+
+#define DIR_PATH  "bench_files"
+#define FILES     2000
+#define FILE_SIZE (16 * 1024)
+#define ROUNDS    10
+
+int main(void) {
+    static char        paths[FILES][48];
+    static const char *path_ptrs[FILES];
+    static mp_String   contents[FILES];
+    static int         errors[FILES];
+
+    mkdir(DIR_PATH, 0755);
+    char *data = malloc(FILE_SIZE);
+    for (size_t i = 0; i < FILE_SIZE; ++i)
+        data[i] = 'a' + rand64() % 26;
+    for (size_t i = 0; i < FILES; ++i) {
+        snprintf(paths[i], sizeof(paths[i]), DIR_PATH "/%zu.txt", i);
+        path_ptrs[i] = paths[i];
+        FILE *file   = fopen(paths[i], "wb");
+        fwrite(data, 1, FILE_SIZE, file);
+        fclose(file);
+    }
+    free(data);
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    printf("  %d files of %d bytes, files in the page cache, %ld CPUs\n", FILES, FILE_SIZE, cpus);
+
+    mp_Arena arena;
+    mp_arena_init(&arena);
+    mp_Allocator alloc = mp_arena_allocator(&arena);
+
+    double start = now();
+    for (int round = 0; round < ROUNDS; ++round) {
+        for (size_t i = 0; i < FILES; ++i)
+            mp_read_entire_file(&alloc, &contents[i], path_ptrs[i]);
+        mp_arena_destroy(&arena);
+        mp_arena_init(&arena);
+    }
+    report("mp_read_entire_file loop", start, (size_t) FILES * ROUNDS);
+
+    size_t thread_counts[] = { 1, 2, 4, 8 };
+    for (size_t t = 0; t < sizeof(thread_counts) / sizeof(*thread_counts); ++t) {
+        char name[64];
+        snprintf(name, sizeof(name), "mp_read_files, %zu threads", thread_counts[t]);
+        start = now();
+        for (int round = 0; round < ROUNDS; ++round) {
+            mp_read_files(&alloc, path_ptrs, FILES, contents, errors, thread_counts[t]);
+            mp_arena_destroy(&arena);
+            mp_arena_init(&arena);
+        }
+        report(name, start, (size_t) FILES * ROUNDS);
+    }
+
+    mp_arena_destroy(&arena);
+    for (size_t i = 0; i < FILES; ++i)
+        remove(paths[i]);
+    rmdir(DIR_PATH);
+    return 0;
+}
@@ -0,0 +1,62 @@
+#include "bench.h"
+
+#define SNAPSHOT_FILE "bench_snapshot.bin"
+#define ENTRIES       2000000
+
+typedef struct {
+    mp_RelString key;
+    uint64_t     value;
+} Entry;
+
+mp_relvector_create(Entries, Entry);
+
+int main(void) {
+    // Building the table from scratch is what a program does without snapshots
+    double    start = now();
+    mp_SArena arena;
+    mp_sarena_init(&arena, (size_t) ENTRIES * 8);
+    mp_Allocator alloc = mp_sarena_allocator(&arena);
+    Entries     *root  = mp_create(&alloc, Entries);
+    Entries_init(root, &alloc, NULL, ENTRIES);
+    Entry *entries = Entries_data(root);
+    char   key[64];
+    for (size_t i = 0; i < ENTRIES; ++i) {
+        int len = snprintf(key, sizeof(key), "user:%zu:profile", (size_t) rand64() % 1000003);
+        mp_relstring_init(&entries[i].key, &alloc, mp_slice(key, len));
+        entries[i].value = mp_hash(key, len);
+    }
+    printf("  %d entries, %zu bytes\n", ENTRIES, arena.len * sizeof(uintptr_t));
+    report("build the table", start, ENTRIES);
+
+    start = now();
+    mp_snapshot_save(&arena, SNAPSHOT_FILE);
+    report("mp_snapshot_save", start, ENTRIES);
+    mp_sarena_destroy(&arena);
+
+    volatile uint64_t sink;
+    mp_Snapshot       snapshot;
+    start = now();
+    mp_snapshot_load(&snapshot, SNAPSHOT_FILE, false);
+    const Entries *loaded = mp_snapshot_root(&snapshot, Entries);
+    sink                  = Entries_get(loaded, ENTRIES / 2).value;
+    report("mp_snapshot_load, one lookup", start, ENTRIES);
+    mp_snapshot_unload(&snapshot);
+
+    start = now();
+    mp_snapshot_load(&snapshot, SNAPSHOT_FILE, true);
+    loaded = mp_snapshot_root(&snapshot, Entries);
+    sink   = Entries_get(loaded, ENTRIES / 2).value;
+    report("mp_snapshot_load verified, one lookup", start, ENTRIES);
+
+    start = now();
+    for (size_t i = 0; i < ENTRIES; ++i) {
+        const Entry *entry = &Entries_data(loaded)[i];
+        sink               = entry->value + mp_relstring_get(&entry->key).cstr[5];
+    }
+    report("read every entry after loading", start, ENTRIES);
+    (void) sink;
+
+    mp_snapshot_unload(&snapshot);
+    remove(SNAPSHOT_FILE);
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include "bench.h"
+
+#define LEN    (1 << 22)
+#define ROUNDS 20
+
+#define PARTICLE_FIELDS(X)                                                                         \
+    X(float, x) X(float, y) X(float, vx) X(float, vy) X(uint8_t, alive) X(uint64_t, id)            \
+    X(uint64_t, flags) X(uint64_t, parent)
+
+mp_soa_create(Particles, PARTICLE_FIELDS);
+
+typedef struct {
+    float    x, y, vx, vy;
+    uint8_t  alive;
+    uint64_t id, flags, parent;
+} Particle;
+
+mp_vector_create(Vector_Particle, Particle);
+
+int main(void) {
+    mp_Allocator heap = mp_heap_allocator();
+
+    Vector_Particle aos;
+    Particles       soa;
+    mp_vector_init(&aos, &heap);
+    Particles_init(&soa, &heap);
+    for (size_t i = 0; i < LEN; ++i) {
+        Particle particle = { (float) (rand64() % 1000), 0, 1, 1, i % 2, i, 0, 0 };
+        mp_append(&aos, particle);
+        Particles_append(&soa,
+                         (Particles_Item){ .x = particle.x, .vx = 1, .vy = 1, .alive = i % 2 });
+    }
+    printf("  %d particles, %zu bytes per particle\n", LEN, sizeof(Particle));
+
+    volatile float sink;
+    double         start = now();
+    for (int round = 0; round < ROUNDS; ++round) {
+        float sum = 0;
+        for (size_t i = 0; i < aos.len; ++i)
+            sum += aos.data[i].x;
+        sink = sum;
+    }
+    report("sum x, array of structs", start, (size_t) LEN * ROUNDS);
+
+    start = now();
+    for (int round = 0; round < ROUNDS; ++round) {
+        float sum = 0;
+        for (size_t i = 0; i < soa.len; ++i)
+            sum += soa.x[i];
+        sink = sum;
+    }
+    report("sum x, mp_soa_create", start, (size_t) LEN * ROUNDS);
+
+    start = now();
+    for (int round = 0; round < ROUNDS; ++round) {
+        for (size_t i = 0; i < aos.len; ++i) {
+            aos.data[i].x += aos.data[i].vx;
+            aos.data[i].y += aos.data[i].vy;
+        }
+        barrier();
+    }
+    report("move, array of structs", start, (size_t) LEN * ROUNDS);
+
+    start = now();
+    for (int round = 0; round < ROUNDS; ++round) {
+        for (size_t i = 0; i < soa.len; ++i) {
+            soa.x[i] += soa.vx[i];
+            soa.y[i] += soa.vy[i];
+        }
+        barrier();
+    }
+    report("move, mp_soa_create", start, (size_t) LEN * ROUNDS);
+    (void) sink;
+
+    mp_vector_destroy(&aos);
+    Particles_destroy(&soa);
+    return 0;
+}
@@ -0,0 +1,113 @@
+#include "bench.h"
+
+// Every size sorts at least this many items in total, so small sizes are repeated
+#define MIN_TOTAL (10 * 1000 * 1000)
+// Only plain integers are sorted at this size, the other kinds would not fit in memory
+#define MAX_LEN   (100 * 1000 * 1000)
+
+typedef struct {
+    uint32_t id;
+    int64_t  score;
+} Entry;
+
+#define entry_less(a, b) ((a).score < (b).score)
+
+mp_sort_create(sort_u32, uint32_t, MP_LESS);
+mp_sort_create(sort_f64, double, MP_LESS);
+mp_sort_create(sort_entry, Entry, entry_less);
+
+static int compare_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *) a, y = *(const uint32_t *) b;
+    return (x > y) - (x < y);
+}
+
+static int compare_f64(const void *a, const void *b) {
+    double x = *(const double *) a, y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+static int compare_entry(const void *a, const void *b) {
+    int64_t x = ((const Entry *) a)->score, y = ((const Entry *) b)->score;
+    return (x > y) - (x < y);
+}
+
+static uint64_t entry_key(const void *item) {
+    return (uint64_t) ((const Entry *) item)->score ^ (UINT64_C(1) << 63);
+}
+
+/* Sorts copies of `input` `rounds` times with `statement`, which sorts `work` of `len` items. */
+#define measure(name, input, work, len, rounds, statement)                                         \
+    do {                                                                                           \
+        double elapsed_ = 0;                                                                       \
+        for (size_t round_ = 0; round_ < (rounds); ++round_) {                                     \
+            memcpy((work), (input), (len) * sizeof(*(work)));                                      \
+            double start_ = now();                                                                 \
+            statement;                                                                             \
+            elapsed_ += now() - start_;                                                            \
+        }                                                                                          \
+        printf("  %-28s %9.2f ns/item\n", name, elapsed_ * 1e9 / (double) ((len) * (rounds)));     \
+    } while (0)
+
+int main(void) {
+    mp_Allocator heap = mp_heap_allocator();
+
+    size_t sizes[] = { 1000, 10 * 1000, 100 * 1000, 1000 * 1000, 10 * 1000 * 1000, MAX_LEN };
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(*sizes); ++s) {
+        size_t len    = sizes[s];
+        size_t rounds = len < MIN_TOTAL ? MIN_TOTAL / len : 1;
+        bool   all    = len < MAX_LEN;
+        printf("  %zu random items, %zu rounds\n", len, rounds);
+
+        uint32_t *u32s = malloc(len * sizeof(uint32_t));
+        uint32_t *work = malloc(len * sizeof(uint32_t));
+        for (size_t i = 0; i < len; ++i)
+            u32s[i] = (uint32_t) rand64();
+        measure("u32 qsort", u32s, work, len, rounds, qsort(work, len, sizeof(*work), compare_u32));
+        measure("u32 mp_sort_create", u32s, work, len, rounds, sort_u32(work, len));
+        measure("u32 mp_radix_sort_u32",
+                u32s,
+                work,
+                len,
+                rounds,
+                mp_radix_sort_u32(work, len, &heap));
+        free(u32s);
+        free(work);
+        if (!all) continue;
+
+        double *f64s = malloc(len * sizeof(double));
+        double *f64w = malloc(len * sizeof(double));
+        for (size_t i = 0; i < len; ++i)
+            f64s[i] = (double) (int64_t) rand64() / 1e6;
+        measure("f64 qsort", f64s, f64w, len, rounds, qsort(f64w, len, sizeof(*f64w), compare_f64));
+        measure("f64 mp_sort_create", f64s, f64w, len, rounds, sort_f64(f64w, len));
+        measure("f64 mp_radix_sort_f64",
+                f64s,
+                f64w,
+                len,
+                rounds,
+                mp_radix_sort_f64(f64w, len, &heap));
+        free(f64s);
+        free(f64w);
+
+        Entry *items  = malloc(len * sizeof(Entry));
+        Entry *itemsw = malloc(len * sizeof(Entry));
+        for (size_t i = 0; i < len; ++i)
+            items[i] = (Entry){ (uint32_t) i, (int64_t) rand64() };
+        measure("struct qsort",
+                items,
+                itemsw,
+                len,
+                rounds,
+                qsort(itemsw, len, sizeof(*itemsw), compare_entry));
+        measure("struct mp_sort_create", items, itemsw, len, rounds, sort_entry(itemsw, len));
+        measure("struct mp_radix_sort_key",
+                items,
+                itemsw,
+                len,
+                rounds,
+                mp_radix_sort_key(itemsw, len, sizeof(Entry), entry_key, &heap));
+        free(items);
+        free(itemsw);
+    }
+    return 0;
+}
@@ -0,0 +1,146 @@
+#include "bench.h"
+
+#define TEXT_SIZE (32 * 1024)
+#define ROUNDS    20000
+
+// The hash mp_hash used before, as a baseline
+static uint64_t fnv1a(const void *data, size_t len) {
+    const uint8_t *bytes = data;
+    uint64_t       hash  = 14695981039346656037ull;
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+int main(void) {
+    // Text over a small alphabet so the first byte of the needle matches often
+    char *text = malloc(TEXT_SIZE + 1);
+    for (size_t i = 0; i < TEXT_SIZE; ++i)
+        text[i] = 'a' + rand64() % 13;
+    text[TEXT_SIZE] = '\0';
+    mp_Slice haystack = mp_slice(text, TEXT_SIZE);
+    mp_Slice needle   = mp_slice_from_cstr("adgjmz");
+    printf("  %d byte haystack, %d rounds, needle not found\n", TEXT_SIZE, ROUNDS);
+
+    volatile size_t sink;
+    double          start = now();
+    for (int round = 0; round < ROUNDS; ++round) {
+        barrier();
+        sink = (size_t) strstr(text, needle.ptr);
+    }
+    report("find, strstr", start, (size_t) TEXT_SIZE * ROUNDS);
+    start = now();
+    for (int round = 0; round < ROUNDS; ++round) {
+        barrier();
+        sink = (size_t) memmem(text, TEXT_SIZE, needle.ptr, needle.len);
+    }
+    report("find, memmem", start, (size_t) TEXT_SIZE * ROUNDS);
+    start = now();
+    for (int round = 0; round < ROUNDS; ++round) {
+        barrier();
+        sink = mp_slice_find(haystack, needle);
+    }
+    report("find, mp_slice_find", start, (size_t) TEXT_SIZE * ROUNDS);
+
+    start = now();
+    for (int round = 0; round < ROUNDS; ++round) {
+        barrier();
+        sink = strcspn(text, "xyz");
+    }
+    report("find any, strcspn", start, (size_t) TEXT_SIZE * ROUNDS);
+    start = now();
+    for (int round = 0; round < ROUNDS; ++round) {
+        barrier();
+        sink = mp_slice_find_any(haystack, "xyz");
+    }
+    report("find any, mp_slice_find_any", start, (size_t) TEXT_SIZE * ROUNDS);
+
+    start = now();
+    for (int round = 0; round < ROUNDS; ++round) {
+        barrier();
+        sink = fnv1a(text, TEXT_SIZE);
+    }
+    report("hash, FNV-1a", start, (size_t) TEXT_SIZE * ROUNDS);
+    start = now();
+    for (int round = 0; round < ROUNDS; ++round) {
+        barrier();
+        sink = mp_hash(text, TEXT_SIZE);
+    }
+    report("hash, mp_hash", start, (size_t) TEXT_SIZE * ROUNDS);
+
+    // Pairs of 64 byte keys, half of them differ in their last byte
+    enum { KEYS = 1024, KEY_LEN = 64 };
+    static char keys_a[KEYS][KEY_LEN + 1], keys_b[KEYS][KEY_LEN + 1];
+    mp_String   strs_a[KEYS], strs_b[KEYS];
+    for (size_t k = 0; k < KEYS; ++k) {
+        for (size_t i = 0; i < KEY_LEN; ++i)
+            keys_a[k][i] = keys_b[k][i] = 'a' + rand64() % 26;
+        keys_b[k][KEY_LEN - 1] = k % 2 == 0 ? keys_a[k][KEY_LEN - 1] : '#';
+        strs_a[k]              = (mp_String){ KEY_LEN, keys_a[k] };
+        strs_b[k]              = (mp_String){ KEY_LEN, keys_b[k] };
+    }
+    size_t compares = (size_t) ROUNDS * 50;
+    start           = now();
+    for (size_t round = 0; round < compares; round += KEYS) {
+        barrier();
+        for (size_t k = 0; k < KEYS; ++k)
+            sink = strcmp(keys_a[k], keys_b[k]) == 0;
+    }
+    report("equal 64 bytes, strcmp", start, compares);
+    start = now();
+    for (size_t round = 0; round < compares; round += KEYS) {
+        barrier();
+        for (size_t k = 0; k < KEYS; ++k)
+            sink = mp_string_eq(strs_a[k], strs_b[k]);
+    }
+    report("equal 64 bytes, mp_string_eq", start, compares);
+    start = now();
+    for (size_t round = 0; round < compares; round += KEYS) {
+        barrier();
+        for (size_t k = 0; k < KEYS; ++k)
+            sink = (size_t) strcmp(keys_a[k], keys_b[k]);
+    }
+    report("order 64 bytes, strcmp", start, compares);
+    start = now();
+    for (size_t round = 0; round < compares; round += KEYS) {
+        barrier();
+        for (size_t k = 0; k < KEYS; ++k)
+            sink = (size_t) mp_string_cmp(strs_a[k], strs_b[k]);
+    }
+    report("order 64 bytes, mp_string_cmp", start, compares);
+    start = now();
+    for (size_t round = 0; round < compares; round += KEYS) {
+        barrier();
+        for (size_t k = 0; k < KEYS; ++k)
+            sink = (size_t) mp_slice_cmp(mp_slice(keys_a[k], KEY_LEN),
+                                         mp_slice(keys_b[k], KEY_LEN));
+    }
+    report("order 64 bytes, mp_slice_cmp", start, compares);
+
+    // Short keys, as hashed by the interner
+    const char *keys[] = { "id", "name", "identifier_42", "a_longer_key_of_some_32_bytes__" };
+    for (size_t k = 0; k < sizeof(keys) / sizeof(*keys); ++k) {
+        size_t len = strlen(keys[k]);
+        char   name[64];
+        snprintf(name, sizeof(name), "hash %zu bytes, FNV-1a", len);
+        start = now();
+        for (int round = 0; round < ROUNDS * 100; ++round) {
+            barrier();
+            sink = fnv1a(keys[k], len);
+        }
+        report(name, start, (size_t) ROUNDS * 100);
+        snprintf(name, sizeof(name), "hash %zu bytes, mp_hash", len);
+        start = now();
+        for (int round = 0; round < ROUNDS * 100; ++round) {
+            barrier();
+            sink = mp_hash(keys[k], len);
+        }
+        report(name, start, (size_t) ROUNDS * 100);
+    }
+    (void) sink;
+
+    free(text);
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include "bench.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#define ALLOCS  2000000
+#define THREADS 4
+
+mp_spsc_create(Queue, void *);
+
+typedef struct {
+    mp_Allocator *alloc;
+    Queue        *queue;
+} Channel;
+
+// Allocates messages of varying sizes and sends them to the consumer, which frees them
+static void *producer(void *arg) {
+    Channel *channel = arg;
+    for (size_t i = 0; i < ALLOCS; ++i) {
+        void *message = mp_alloc(channel->alloc, 16 + (i * 37) % 300);
+        while (!Queue_push(channel->queue, message))
+            sched_yield();
+    }
+    return NULL;
+}
+
+static void *consumer(void *arg) {
+    Channel *channel = arg;
+    for (size_t i = 0; i < ALLOCS; ++i) {
+        void *message;
+        while (!Queue_pop(channel->queue, &message))
+            sched_yield();
+        mp_free(channel->alloc, message);
+    }
+    return NULL;
+}
+
+// Allocates and frees on the same thread, keeping up to 64 blocks alive
+static void *local(void *arg) {
+    Channel *channel  = arg;
+    void    *live[64] = { 0 };
+    for (size_t i = 0; i < ALLOCS; ++i) {
+        size_t slot = i & 63;
+        if (live[slot] != NULL) mp_free(channel->alloc, live[slot]);
+        live[slot] = mp_alloc(channel->alloc, 16 + (i * 37) % 300);
+    }
+    for (size_t i = 0; i < 64; ++i)
+        mp_free(channel->alloc, live[i]);
+    return NULL;
+}
+
+static void run(const char *name, mp_Allocator *alloc, bool cross_thread) {
+    mp_Allocator heap = mp_heap_allocator();
+    Queue        queues[THREADS];
+    Channel      channels[THREADS];
+    pthread_t    producers[THREADS], consumers[THREADS];
+
+    double start = now();
+    for (size_t i = 0; i < THREADS; ++i) {
+        Queue_init(&queues[i], &heap, 4096);
+        channels[i] = (Channel){ alloc, &queues[i] };
+        if (cross_thread) {
+            pthread_create(&producers[i], NULL, producer, &channels[i]);
+            pthread_create(&consumers[i], NULL, consumer, &channels[i]);
+        } else {
+            pthread_create(&producers[i], NULL, local, &channels[i]);
+        }
+    }
+    for (size_t i = 0; i < THREADS; ++i) {
+        pthread_join(producers[i], NULL);
+        if (cross_thread) pthread_join(consumers[i], NULL);
+        Queue_destroy(&queues[i]);
+    }
+    report(name, start, (size_t) ALLOCS * THREADS);
+}
+
+int main(void) {
+    mp_Allocator  heap = mp_heap_allocator();
+    mp_ThreadHeap thread_heap;
+    mp_thread_heap_init(&thread_heap);
+    mp_Allocator alloc = mp_thread_heap_allocator(&thread_heap);
+    long         cpus  = sysconf(_SC_NPROCESSORS_ONLN);
+    printf("  %d threads, %d allocations each, %ld CPUs\n", THREADS, ALLOCS, cpus);
+
+    run("same thread, mp_heap_allocator", &heap, false);
+    run("same thread, mp_thread_heap", &alloc, false);
+    run("cross thread, mp_heap_allocator", &heap, true);
+    run("cross thread, mp_thread_heap", &alloc, true);
+
+    mp_thread_heap_destroy(&thread_heap);
+    return 0;
+}
@@ -29,6 +29,28 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__unix__) || defined(__APPLE__)
+#define MEMPLUS_POSIX
+#endif
+
+/* Define MEMPLUS_NO_THREADS to leave out everything that needs atomics or threads.
+ * Everything that needs pthreads is also left out on systems that are not POSIX. */
+#if defined(__STDC_NO_ATOMICS__) && !defined(MEMPLUS_NO_THREADS)
+#define MEMPLUS_NO_THREADS
+#endif
+
+#ifndef MEMPLUS_NO_THREADS
+#include <stdatomic.h>
+#ifdef MEMPLUS_POSIX
+#include <pthread.h>
+#endif
+#endif
+
+/* Size of a cache line in bytes. You can adjust this to your liking. */
+#ifndef MP_CACHE_LINE_SIZE
+#define MP_CACHE_LINE_SIZE 64
+#endif
+
 #ifndef MEMPLUS_ASSERT
 #include <assert.h>
 #define MEMPLUS_ASSERT assert
@@ -181,6 +203,77 @@ mp_Allocator mp_temp_allocator(const mp_Temp *self);
 
 mp_Allocator mp_heap_allocator(void);
 
+#if defined(MEMPLUS_POSIX) && !defined(MEMPLUS_NO_THREADS) && defined(__STDC_VERSION__) &&         \
+    __STDC_VERSION__ >= 201112L
+/* THREAD CACHE ALLOCATOR
+ * Thread-safe general purpose allocator. Every thread allocates from its own cache of free blocks
+ * without locking. A block freed by another thread is pushed to the lock-free list of the cache
+ * that allocated it and is reused by that cache. Caches take blocks from the global pool when they
+ * run dry and give surplus blocks back to it, both under a mutex. When a thread exits, its cache
+ * is kept for the next new thread. Sizes above the largest size class go to malloc directly.
+ * Memory of the size classes is only given back to the system by `mp_thread_heap_destroy`.
+ * Needs C11 for `_Atomic`, unlike the rest of the library. */
+
+/* Amount of blocks moved between a cache and the global pool at once.
+ * You can adjust this to your liking. */
+#ifndef MP_THREAD_HEAP_BATCH
+#define MP_THREAD_HEAP_BATCH 32
+#endif
+/* Block sizes are powers of two from 32 bytes to 32 << (`MP_THREAD_HEAP_CLASSES` - 1) bytes,
+ * including a 16 bytes header. */
+#define MP_THREAD_HEAP_CLASSES 12
+/* Size of the memory requested from the system at once for blocks of the same size. */
+#define MP_THREAD_HEAP_SLAB_SIZE (64 * 1024)
+
+typedef struct mp_HeapBlock   mp_HeapBlock;
+typedef struct mp_ThreadCache mp_ThreadCache;
+typedef struct mp_ThreadHeap  mp_ThreadHeap;
+
+/* Header in front of every block. */
+struct mp_HeapBlock {
+    union {
+        mp_ThreadCache *owner;    // While allocated: the cache that allocated it
+        mp_HeapBlock   *next;     // While free: the next free block
+    } link;
+    size_t size_class;    // `MP_THREAD_HEAP_CLASSES` for blocks from malloc
+};
+
+typedef struct {
+    mp_HeapBlock *head;
+    size_t        len;
+} mp_HeapBlockList;
+
+/* Free blocks of a single thread. */
+struct mp_ThreadCache {
+    mp_ThreadHeap   *heap;
+    mp_ThreadCache  *next;         // The next cache in `mp_ThreadHeap.caches`
+    mp_ThreadCache  *next_idle;    // The next cache in `mp_ThreadHeap.idle`
+    mp_HeapBlockList free[MP_THREAD_HEAP_CLASSES];
+    uint8_t          pad0[MP_CACHE_LINE_SIZE];
+    // Blocks freed by other threads. Any thread pushes, only the owner takes the whole list.
+    _Atomic(mp_HeapBlock *) remote;
+    uint8_t                 pad1[MP_CACHE_LINE_SIZE];
+};
+
+struct mp_ThreadHeap {
+    pthread_key_t    key;                             // The cache of the current thread
+    pthread_mutex_t  lock;                            // Protects everything below
+    mp_ThreadCache  *caches;                          // Every cache created
+    mp_ThreadCache  *idle;                            // Caches without a thread
+    mp_HeapBlockList free[MP_THREAD_HEAP_CLASSES];    // The global pool
+    void            *slabs;                           // Linked list of memory from the system
+};
+
+/* Initializes an empty allocator. Nothing is allocated until the first allocation. */
+void mp_thread_heap_init(mp_ThreadHeap *self);
+/* Frees every cache and block. Must only be called once no thread uses the allocator anymore.
+ * Blocks from malloc that were never freed are leaked. */
+void mp_thread_heap_destroy(mp_ThreadHeap *self);
+/* Returns an allocator that works with `mp_ThreadHeap`. Any thread may use it.
+ * Allocated memory is zeroed like with the other allocators. */
+mp_Allocator mp_thread_heap_allocator(const mp_ThreadHeap *self);
+#endif /* if defined(MEMPLUS_POSIX) && !defined(MEMPLUS_NO_THREADS) && C11 */
+
 /***********
  * END OF ALLOCATOR
  ***********/
@@ -195,22 +288,220 @@ typedef struct {
     char  *cstr;
 } mp_String;
 
+#ifndef MP_STRING_FORMAT_BUFFER_SIZE
+/* Size of the stack buffer `mp_string_newf` formats into before allocating. */
+#define MP_STRING_FORMAT_BUFFER_SIZE 256
+#endif
+
 /* In the case of functions that return mp_String,
  * the returned mp_String.cstr == NULL and mp_String.len == 0 if allocation failed. */
 
 /* Allocates a new `mp_String` from a null-terminated string. */
 mp_String mp_string_new(const mp_Allocator *allocator, const char *str);
-/* Allocates a new `mp_String` from formatted input. */
+/* Allocates a new `mp_String` from formatted input.
+ * Formats without `vsnprintf` if `fmt` only uses `%%`, `%c`, `%s`, `%.Ns`, `%.*s` and `%d`, `%i`,
+ * `%u` or `%x` with no length modifier or `l`, `ll` or `z`, and the result fits in
+ * `MP_STRING_FORMAT_BUFFER_SIZE`. Otherwise it calls `vsnprintf` twice: to count and to format. */
 mp_String mp_string_newf(const mp_Allocator *allocator, const char *fmt, ...);
 /* Allocates duplicate of `str`. */
 mp_String mp_string_dup(const mp_Allocator *allocator, mp_String str);
 /* Free an `mp_String`. */
 void mp_string_destroy(const mp_Allocator *allocator, mp_String *str);
 
+/* NUMBER FORMATTING
+ * Writes a number into `buf` without allocating and returns the amount of characters written.
+ * The output is not null-terminated. `buf` must have room for `MP_FORMAT_*_SIZE` characters. */
+#define MP_FORMAT_INT_SIZE    20
+#define MP_FORMAT_DOUBLE_SIZE 24
+
+/* Integers are converted two digits at a time. */
+size_t mp_format_int(char *buf, long long value);
+size_t mp_format_uint(char *buf, unsigned long long value);
+/* Writes the shortest representation that reads back as exactly `value` (Ryu). Uses plain decimal
+ * notation if the decimal exponent is in [-4, 17) and `1.5e+17` notation otherwise. Writes "inf",
+ * "-inf" and "nan" for the special values. */
+size_t mp_format_double(char *buf, double value);
+
+/* STRING BUILDER
+ * Growable buffer for building a string.
+ * Follows the vector layout with `len` excluding the null-terminator. Once allocated, the buffer is
+ * always null-terminated. The capacity doubles like `mp_resize` and the arena allocators extend the
+ * buffer in place while it is their last allocation. */
+typedef struct {
+    mp_Allocator *alloc;
+    size_t        len;
+    size_t        cap;
+    char         *data;
+} mp_StringBuilder;
+
+/* Functions below that return bool return false if allocation failed.
+ * The content of the builder is left untouched then. */
+
+/* Initializes a new empty string builder and tell it to use `allocator`. */
+void mp_string_builder_init(mp_StringBuilder *self, mp_Allocator *allocator);
+/* Frees the string builder. */
+void mp_string_builder_destroy(mp_StringBuilder *self);
+/* Sets the length to 0 while keeping the buffer. */
+void mp_string_builder_clear(mp_StringBuilder *self);
+/* Makes sure `amount` more characters and the null-terminator fit without reallocating. */
+bool mp_string_builder_reserve(mp_StringBuilder *self, size_t amount);
+/* Appends `len` bytes from `str`. */
+bool mp_string_builder_append(mp_StringBuilder *self, const char *str, size_t len);
+/* Appends a null-terminated string. */
+bool mp_string_builder_append_cstr(mp_StringBuilder *self, const char *cstr);
+/* Appends an `mp_String`. */
+bool mp_string_builder_append_string(mp_StringBuilder *self, mp_String str);
+/* Appends a single character. */
+bool mp_string_builder_append_char(mp_StringBuilder *self, char c);
+/* Appends an integer in decimal. */
+bool mp_string_builder_append_int(mp_StringBuilder *self, long long value);
+bool mp_string_builder_append_uint(mp_StringBuilder *self, unsigned long long value);
+/* Appends the shortest representation of `value` that reads back exactly. */
+bool mp_string_builder_append_double(mp_StringBuilder *self, double value);
+/* Appends formatted input. Formats directly into the remaining capacity and only formats again if
+ * the result did not fit. Skips `vsnprintf` for the same formats as `mp_string_newf`. */
+bool mp_string_builder_appendf(mp_StringBuilder *self, const char *fmt, ...);
+/* Hands the buffer over as an `mp_String` without copying and resets the builder.
+ * The string is managed by the builder's allocator. */
+mp_String mp_string_builder_to_string(mp_StringBuilder *self);
+
+/* SLICE
+ * Non-owning view of `len` characters starting at `ptr`. It is not null-terminated.
+ * None of the slice functions allocate. */
+typedef struct {
+    size_t      len;
+    const char *ptr;
+} mp_Slice;
+
+/* Creates a slice of `len` characters starting at `ptr`. */
+// ptr: const char*
+// len: size_t
+// -> mp_Slice
+#define mp_slice(ptr, len) ((mp_Slice){ (len), (ptr) })
+
+/* Creates a slice viewing a null-terminated string or an `mp_String`. */
+mp_Slice mp_slice_from_cstr(const char *cstr);
+mp_Slice mp_slice_from_string(mp_String str);
+/* Allocates a new `mp_String` with the content of `slice`. */
+mp_String mp_string_from_slice(const mp_Allocator *allocator, mp_Slice slice);
+/* Returns the characters in [begin, end). Both are clamped to the length of the slice. */
+mp_Slice mp_slice_sub(mp_Slice self, size_t begin, size_t end);
+/* Removes whitespace from the start, the end, or both ends of the slice. */
+mp_Slice mp_slice_trim_left(mp_Slice self);
+mp_Slice mp_slice_trim_right(mp_Slice self);
+mp_Slice mp_slice_trim(mp_Slice self);
+/* Iterates over the fields of `rest` separated by `delim`, writing the next one to `field`.
+ * Empty fields are kept. Returns false after the last field.
+ *     mp_Slice rest = mp_slice_from_cstr("a,,b"), field;
+ *     while (mp_slice_split_next(&rest, ',', &field)) ... // "a", "", "b" */
+bool mp_slice_split_next(mp_Slice *rest, char delim, mp_Slice *field);
+/* Same as `mp_slice_split_next`, but any character in the null-terminated `delims` separates the
+ * tokens and empty tokens are skipped. */
+bool mp_slice_tokenize_next(mp_Slice *rest, const char *delims, mp_Slice *token);
+
+/* STRING OPERATIONS
+ * Searching uses SSE2 or AVX2 when the target supports it and falls back to scalar code otherwise.
+ * On x86-64 with GCC or Clang, AVX2 is also used without -mavx2 when the CPU supports it. */
+
+/* Returned by search functions if nothing was found. */
+#define MP_NPOS ((size_t) -1)
+
+/* Returns true if both strings have the same content. Lengths are compared first. */
+bool mp_string_eq(mp_String a, mp_String b);
+bool mp_slice_eq(mp_Slice a, mp_Slice b);
+/* Compares two strings lexicographically by their bytes, like strcmp. */
+int mp_string_cmp(mp_String a, mp_String b);
+int mp_slice_cmp(mp_Slice a, mp_Slice b);
+/* Returns the index of the first occurrence of `needle` in `self` or `MP_NPOS`. */
+size_t mp_slice_find(mp_Slice self, mp_Slice needle);
+/* Returns the index of the first character in `self` that is also in the null-terminated `chars`
+ * or `MP_NPOS`. */
+size_t mp_slice_find_any(mp_Slice self, const char *chars);
+/* Returns a non-cryptographic 64-bit hash of `len` bytes from `data` (wyhash).
+ * Suitable for hash tables and interners, not for anything exposed to untrusted input. */
+uint64_t mp_hash(const void *data, size_t len);
+
 /***********
  * END OF STRING
  ***********/
 
+/***********
+ * INTERNER
+ ***********/
+
+/* Starting amount of slots in the hash index of an interner. Must be a power of two.
+ * You can adjust this to your liking. */
+#ifndef MP_INTERNER_INIT_CAPACITY
+#define MP_INTERNER_INIT_CAPACITY 256
+#endif
+
+typedef struct {
+    uint64_t    hash;
+    const char *cstr;    // NULL if the slot is empty
+} mp_InternSlot;
+
+/* Stores each unique string once in an arena, so interned strings can be compared by their
+ * pointers: `a.cstr == b.cstr`. Interned strings stay valid until the interner is destroyed and
+ * must not be modified.
+ * The hash index is an open addressing table allocated from `alloc`. Growing the index on an arena
+ * allocator leaves the old index behind in the arena. */
+typedef struct {
+    mp_Arena       arena;    // Holds the strings
+    mp_Allocator  *alloc;    // Holds the hash index
+    size_t         len;      // The amount of unique strings
+    size_t         cap;      // The amount of slots in the index
+    mp_InternSlot *slots;
+} mp_Interner;
+
+/* Initializes an empty interner and tell it to allocate the hash index with `allocator`. */
+void mp_interner_init(mp_Interner *self, mp_Allocator *allocator);
+/* Frees the interner and every string interned in it. */
+void mp_interner_destroy(mp_Interner *self);
+/* Returns the interned copy of `str`, interning it first if needed.
+ * Returns an `mp_String` with cstr == NULL if allocation failed. */
+mp_String mp_interner_intern(mp_Interner *self, mp_Slice str);
+/* Same as `mp_interner_intern` with `hash` precomputed by `mp_hash`. */
+mp_String mp_interner_intern_hashed(mp_Interner *self, mp_Slice str, uint64_t hash);
+/* Interns `amount` strings from `strs` and writes the results to `output`.
+ * Returns false if allocation failed. */
+bool mp_interner_intern_many(mp_Interner   *self,
+                             const mp_Slice *strs,
+                             size_t          amount,
+                             mp_String      *output);
+/* Returns the interned copy of `str` without interning it.
+ * Returns an `mp_String` with cstr == NULL if `str` was never interned. */
+mp_String mp_interner_find(const mp_Interner *self, mp_Slice str);
+
+#if defined(MEMPLUS_POSIX) && !defined(MEMPLUS_NO_THREADS)
+/* Amount of shards in a shared interner. Must be a power of two.
+ * You can adjust this to your liking. */
+#ifndef MP_INTERNER_SHARDS
+#define MP_INTERNER_SHARDS 16
+#endif
+
+typedef struct {
+    pthread_mutex_t lock;
+    mp_Interner     interner;
+    uint8_t         pad[MP_CACHE_LINE_SIZE];
+} mp_InternerShard;
+
+/* Thread-safe interner. Strings are distributed over independently locked interners by the top
+ * bits of their hash, so threads interning different strings rarely wait on each other.
+ * The allocator for the hash indices must be thread-safe, e.g. `mp_heap_allocator`. */
+typedef struct {
+    mp_InternerShard shards[MP_INTERNER_SHARDS];
+} mp_SharedInterner;
+
+void      mp_shared_interner_init(mp_SharedInterner *self, mp_Allocator *allocator);
+void      mp_shared_interner_destroy(mp_SharedInterner *self);
+mp_String mp_shared_interner_intern(mp_SharedInterner *self, mp_Slice str);
+mp_String mp_shared_interner_intern_hashed(mp_SharedInterner *self, mp_Slice str, uint64_t hash);
+#endif /* if defined(MEMPLUS_POSIX) && !defined(MEMPLUS_NO_THREADS) */
+
+/***********
+ * END OF INTERNER
+ ***********/
+
 /***********
  * VECTOR
  ***********/
@@ -474,296 +765,3383 @@ void mp_string_destroy(const mp_Allocator *allocator, mp_String *str);
     (self)->data[pos];                                                                             \
     mp_unordered_erase((self), (pos))
 
-/***********
- * END OF VECTOR
- ***********/
+/* STRUCT OF ARRAYS VECTOR
+ * Stores every field of an item in its own column so loops touching a few fields only load those
+ * fields. The fields are declared with an X-macro that calls its argument with `(type, field)`:
+ *     #define PARTICLE_FIELDS(X) X(float, x) X(float, y) X(uint32_t, id)
+ *     mp_soa_create(Particles, PARTICLE_FIELDS);
+ * Every column lives in a single block allocated from the allocator and starts at a multiple of
+ * `MP_SOA_ALIGN` bytes. Columns are plain pointers (`particles.x[i]`), but they are invalidated
+ * whenever the vector grows. */
 
-/**********
- * MISCELLANEOUS
- **********/
+/* Alignment of every column in bytes. You can adjust this to your liking. */
+#ifndef MP_SOA_ALIGN
+#define MP_SOA_ALIGN 64
+#endif
 
-/* Reads and allocates the content in `file_path` and return it to `output`.
- * Returns false if failed and sets errno through stdlib functions. */
-bool mp_read_entire_file(mp_Allocator *allocator, mp_String *output, const char *file_path);
+#define MP_SOA_ITEM_FIELD(type, field)   type field;
+#define MP_SOA_COLUMN_FIELD(type, field) type *field;
+#define MP_SOA_COLUMN_BYTES(type, field)                                                           \
+    +((new_cap) * sizeof(type) + MP_SOA_ALIGN - 1) / MP_SOA_ALIGN * MP_SOA_ALIGN
+#define MP_SOA_RELOCATE(type, field)                                                               \
+    {                                                                                              \
+        type *column = (type *) (base + offset);                                                   \
+        if (self->len > 0) memcpy(column, self->field, self->len * sizeof(type));                  \
+        self->field = column;                                                                      \
+        offset += 0 MP_SOA_COLUMN_BYTES(type, field);                                              \
+    }
+#define MP_SOA_SHIFT_RIGHT(type, field)                                                            \
+    memmove(self->field + pos + 1, self->field + pos, (self->len - pos) * sizeof(type));
+#define MP_SOA_SHIFT_LEFT(type, field)                                                             \
+    memmove(self->field + pos, self->field + pos + 1, (self->len - pos - 1) * sizeof(type));
+#define MP_SOA_MOVE(type, field)     self->field[pos] = self->field[self->len - 1];
+#define MP_SOA_GET(type, field)      result.field = self->field[i];
+#define MP_SOA_SET(type, field)      self->field[i] = item.field;
 
-/**********
- * END OF MISCELLANEOUS
- **********/
+/* Defines a struct of arrays vector `name` and its row type `name##_Item` given the `fields`
+ * X-macro. Defines the following functions:
+ *     void        name##_init(name *self, mp_Allocator *allocator);
+ *     void        name##_destroy(name *self);
+ *     bool        name##_reserve(name *self, size_t new_cap);
+ *     bool        name##_resize(name *self, size_t new_len);  // New items are uninitialized
+ *     bool        name##_append(name *self, name##_Item item);
+ *     bool        name##_insert(name *self, size_t pos, name##_Item item);
+ *     void        name##_erase(name *self, size_t pos);
+ *     void        name##_unordered_erase(name *self, size_t pos);
+ *     name##_Item name##_pop(name *self);
+ *     name##_Item name##_get(const name *self, size_t i);
+ *     void        name##_set(name *self, size_t i, name##_Item item);
+ * Functions returning bool return false if allocation failed, the vector is left untouched then.
+ * The capacity grows the same way as `mp_resize`. */
+// name: identifier
+// fields: identifier
+#define mp_soa_create(name, fields)                                                                \
+    typedef struct {                                                                               \
+        fields(MP_SOA_ITEM_FIELD)                                                                  \
+    } name##_Item;                                                                                 \
+                                                                                                   \
+    typedef struct {                                                                               \
+        mp_Allocator *alloc;                                                                       \
+        size_t        len;                                                                         \
+        size_t        cap;                                                                         \
+        void         *block;                                                                       \
+        fields(MP_SOA_COLUMN_FIELD)                                                                \
+    } name;                                                                                        \
+                                                                                                   \
+    static inline void name##_init(name *self, mp_Allocator *allocator) {                          \
+        *self       = (name){ 0 };                                                                 \
+        self->alloc = allocator;                                                                   \
+    }                                                                                              \
+                                                                                                   \
+    static inline void name##_destroy(name *self) {                                                \
+        if (self->block != NULL) mp_free(self->alloc, self->block);                                \
+        *self = (name){ 0 };                                                                       \
+    }                                                                                              \
+                                                                                                   \
+    static inline bool name##_reserve(name *self, size_t new_cap) {                                \
+        if (new_cap <= self->cap) return true;                                                     \
+        void *block = mp_alloc(self->alloc, MP_SOA_ALIGN - 1 fields(MP_SOA_COLUMN_BYTES));         \
+        if (block == NULL) return false;                                                           \
+        uint8_t *base   = (uint8_t *) (((uintptr_t) block + MP_SOA_ALIGN - 1) &                    \
+                                     ~(uintptr_t) (MP_SOA_ALIGN - 1));                             \
+        size_t   offset = 0;                                                                       \
+        fields(MP_SOA_RELOCATE)                                                                    \
+        if (self->block != NULL) mp_free(self->alloc, self->block);                                \
+        self->block = block;                                                                       \
+        self->cap   = new_cap;                                                                     \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    static inline bool name##_grow(name *self, size_t amount) {                                    \
+        if (self->len + amount <= self->cap) return true;                                          \
+        size_t new_cap = self->cap == 0 ? MP_VECTOR_INIT_CAPACITY : self->cap;                     \
+        while (self->len + amount > new_cap)                                                       \
+            new_cap *= 2;                                                                          \
+        return name##_reserve(self, new_cap);                                                      \
+    }                                                                                              \
+                                                                                                   \
+    static inline bool name##_resize(name *self, size_t new_len) {                                 \
+        if (new_len > self->len && !name##_grow(self, new_len - self->len)) return false;          \
+        self->len = new_len;                                                                       \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    static inline name##_Item name##_get(const name *self, size_t i) {                             \
+        name##_Item result;                                                                        \
+        fields(MP_SOA_GET)                                                                         \
+        return result;                                                                             \
+    }                                                                                              \
+                                                                                                   \
+    static inline void name##_set(name *self, size_t i, name##_Item item) {                        \
+        fields(MP_SOA_SET)                                                                         \
+    }                                                                                              \
+                                                                                                   \
+    static inline bool name##_append(name *self, name##_Item item) {                               \
+        if (!name##_grow(self, 1)) return false;                                                   \
+        name##_set(self, self->len++, item);                                                       \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    static inline bool name##_insert(name *self, size_t pos, name##_Item item) {                   \
+        if (pos > self->len) pos = self->len;                                                      \
+        if (!name##_grow(self, 1)) return false;                                                   \
+        fields(MP_SOA_SHIFT_RIGHT)                                                                 \
+        name##_set(self, pos, item);                                                               \
+        ++self->len;                                                                               \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    static inline void name##_erase(name *self, size_t pos) {                                      \
+        MEMPLUS_ASSERT(pos < self->len && "index out of bounds");                                  \
+        fields(MP_SOA_SHIFT_LEFT)                                                                  \
+        --self->len;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    static inline void name##_unordered_erase(name *self, size_t pos) {                            \
+        MEMPLUS_ASSERT(pos < self->len && "index out of bounds");                                  \
+        fields(MP_SOA_MOVE)                                                                        \
+        --self->len;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    static inline name##_Item name##_pop(name *self) {                                             \
+        MEMPLUS_ASSERT(self->len > 0 && "pop from empty vector");                                  \
+        return name##_get(self, --self->len);                                                      \
+    }
 
-/***********
- * IMPLEMENTATION
- ***********/
+/* SEGMENTED VECTOR
+ * A vector whose items live in chunks that are never moved once allocated, so pointers to the items
+ * stay valid as the vector grows and growing never copies. Chunk `k` holds
+ * `1 << (MP_SEGVEC_CHUNK_SHIFT + k)` items, so the index of chunks stays small and an item is
+ * found in O(1) with a bit scan. */
 
-#ifdef MEMPLUS_IMPLEMENTATION
+/* The first chunk holds `1 << MP_SEGVEC_CHUNK_SHIFT` items. You can adjust this to your liking. */
+#ifndef MP_SEGVEC_CHUNK_SHIFT
+#define MP_SEGVEC_CHUNK_SHIFT 6
+#endif
 
-/* Functions that are used by `mp_*_new_allocator` to define the allocator. */
-static void *mp_arena_alloc(mp_Arena *self, size_t size);
-static void *mp_arena_realloc(mp_Arena *self, void *old_ptr, size_t old_size, size_t new_size);
-static void *mp_arena_dup(mp_Arena *self, void *data, size_t size);
-static void  mp_arena_free(mp_Arena *self, void *ptr);
+/* Maximum amount of chunks, enough to address the whole `size_t` range. */
+#define MP_SEGVEC_MAX_CHUNKS (sizeof(size_t) * 8 - MP_SEGVEC_CHUNK_SHIFT)
 
-static void *mp_sarena_alloc(mp_SArena *self, size_t size);
-static void *mp_sarena_realloc(mp_SArena *self, void *old_ptr, size_t old_size, size_t new_size);
-static void *mp_sarena_dup(mp_SArena *self, void *data, size_t size);
-static void  mp_sarena_free(mp_SArena *self, void *ptr);
+/* Defines a segmented vector struct given `name` and the data `type`. */
+// name: identifier
+// type: typename
+#define mp_segvec_create(name, type)                                                               \
+    typedef struct {                                                                               \
+        mp_Allocator *alloc;                                                                       \
+        size_t        len;                                                                         \
+        size_t        cap;                                                                         \
+        size_t        chunks_len;                                                                  \
+        type         *chunks[MP_SEGVEC_MAX_CHUNKS];                                                \
+    } name
 
-static void *mp_heap_alloc(void *self, size_t size);
-static void *mp_heap_realloc(void *self, void *old_ptr, size_t old_size, size_t new_size);
-static void *mp_heap_dup(void *self, void *data, size_t size);
-static void  mp_heap_free(void *self, void *ptr);
+/* Initializes a new segmented vector and tell it to use `allocator`. */
+// self: SegVector*
+// allocator: mp_Allocator*
+#define mp_segvec_init(self, allocator)                                                            \
+    do {                                                                                           \
+        (self)->alloc      = (allocator);                                                          \
+        (self)->len        = 0;                                                                    \
+        (self)->cap        = 0;                                                                    \
+        (self)->chunks_len = 0;                                                                    \
+    } while (0)
 
-mp_Region *mp_region_new(size_t cap) {
-    size_t     bytes  = sizeof(mp_Region) + sizeof(uintptr_t) * cap;
-    mp_Region *region = calloc(bytes, 1);
-    region->next      = NULL;
-    region->len       = 0;
-    region->cap       = cap;
-    return region;
-}
+/* Frees the segmented vector. */
+// self: SegVector*
+#define mp_segvec_destroy(self)                                                                    \
+    do {                                                                                           \
+        for (size_t k = 0; k < (self)->chunks_len; ++k)                                            \
+            mp_free((self)->alloc, (self)->chunks[k]);                                             \
+        (self)->alloc      = NULL;                                                                 \
+        (self)->len        = 0;                                                                    \
+        (self)->cap        = 0;                                                                    \
+        (self)->chunks_len = 0;                                                                    \
+    } while (0)
 
-void mp_region_free(mp_Region *self) {
-    free(self);
-}
+/* Gets the index of the first item in chunk `k` and the capacity of chunk `k`. */
+// k: size_t
+// -> size_t
+#define mp_segvec_chunk_start(k) ((((size_t) 1 << (k)) - 1) << MP_SEGVEC_CHUNK_SHIFT)
+#define mp_segvec_chunk_cap(k)   ((size_t) 1 << (MP_SEGVEC_CHUNK_SHIFT + (k)))
 
-void mp_arena_init(mp_Arena *self) {
-    self->len   = 0;
-    self->begin = NULL;
-    self->end   = NULL;
-}
+/* Gets the chunk containing the item at index `i` and the position of that item in the chunk. */
+// i: size_t
+// k: size_t
+// -> size_t
+#define mp_segvec_chunk(i)     mp_log2(((i) >> MP_SEGVEC_CHUNK_SHIFT) + 1)
+#define mp_segvec_offset(i, k) ((i) - mp_segvec_chunk_start(k))
 
-void mp_arena_destroy(mp_Arena *self) {
-    mp_Region *region = self->begin;
-    while (region) {
-        mp_Region *region_temp = region;
-        region                 = region->next;
-        mp_region_free(region_temp);
-    }
-    self->begin = NULL;
-    self->end   = NULL;
-}
+/* Gets the amount of items stored in chunk `k`.
+ * Iterating `chunks[k][0..mp_segvec_chunk_len(self, k)]` for every `k` below `chunks_len`
+ * visits every item in order. */
+// self: SegVector*
+// k: size_t
+// -> size_t
+#define mp_segvec_chunk_len(self, k)                                                               \
+    ((self)->len <= mp_segvec_chunk_start(k)                                                       \
+         ? 0                                                                                       \
+     : (self)->len - mp_segvec_chunk_start(k) < mp_segvec_chunk_cap(k)                             \
+         ? (self)->len - mp_segvec_chunk_start(k)                                                  \
+         : mp_segvec_chunk_cap(k))
 
-mp_Allocator mp_arena_allocator(const mp_Arena *self) {
-    return mp_allocator_new(self, mp_arena_alloc, mp_arena_realloc, mp_arena_dup, mp_arena_free);
-}
+/* Gets an item at index `i`. */
+// self: SegVector*
+// i: size_t
+#define mp_segvec_get(self, i)                                                                     \
+    (self)->chunks[mp_segvec_chunk(i)][mp_segvec_offset((i), mp_segvec_chunk(i))]
 
-static void *mp_arena_alloc(mp_Arena *self, size_t size) {
-    // size in words
-    size_t size_word = (size + sizeof(uintptr_t) - 1) / sizeof(uintptr_t);
+/* Allocates chunks until the capacity is at least `new_cap`. Existing items are never moved.
+ * self.cap < new_cap if allocation failed. */
+// self: SegVector*
+// new_cap: size_t
+#define mp_segvec_reserve(self, new_cap)                                                           \
+    do {                                                                                           \
+        while ((self)->cap < (new_cap) && (self)->chunks_len < MP_SEGVEC_MAX_CHUNKS) {             \
+            size_t chunk_cap = mp_segvec_chunk_cap((self)->chunks_len);                            \
+            void  *chunk     = mp_alloc((self)->alloc, chunk_cap * sizeof(**(self)->chunks));      \
+            if (chunk == NULL) break;                                                              \
+            (self)->chunks[(self)->chunks_len++] = chunk;                                          \
+            (self)->cap += chunk_cap;                                                              \
+        }                                                                                          \
+    } while (0)
 
-    if (self->end == NULL) {
-        MEMPLUS_ASSERT(self->begin == NULL);
-        size_t capacity = MP_REGION_DEFAULT_SIZE;
-        if (capacity < size_word) capacity = size_word;
-        self->end = mp_region_new(capacity);
-        if (self->end == NULL) return NULL;
-        self->begin = self->end;
-    }
+/* Appends item to the end, allocating a new chunk if needed.
+ * self.len stays the same if allocation failed. */
+// self: SegVector*
+// item: value of the same type as the vector data
+#define mp_segvec_append(self, item)                                                               \
+    do {                                                                                           \
+        if ((self)->len == (self)->cap) mp_segvec_reserve((self), (self)->len + 1);                \
+        if ((self)->len < (self)->cap) {                                                           \
+            mp_segvec_get((self), (self)->len) = (item);                                           \
+            ++(self)->len;                                                                         \
+        }                                                                                          \
+    } while (0)
 
-    while (self->end->len + size_word > self->end->cap && self->end->next != NULL) {
-        self->end = self->end->next;
-    }
+/* Appends items from `items_ptr` to the end with one memcpy per chunk touched.
+ * self.len stays the same if allocation failed. */
+// self: SegVector*
+// items_ptr: pointer to the same type as the vector data
+// items_amount: size_t
+#define mp_segvec_append_many(self, items_ptr, items_amount)                                       \
+    do {                                                                                           \
+        mp_segvec_reserve((self), (self)->len + (items_amount));                                   \
+        if ((self)->len + (items_amount) <= (self)->cap) {                                         \
+            size_t copied = 0;                                                                     \
+            while (copied < (items_amount)) {                                                      \
+                size_t k      = mp_segvec_chunk((self)->len);                                      \
+                size_t offset = mp_segvec_offset((self)->len, k);                                  \
+                size_t amount = mp_segvec_chunk_cap(k) - offset;                                   \
+                if (amount > (items_amount) - copied) amount = (items_amount) - copied;            \
+                memcpy((self)->chunks[k] + offset,                                                 \
+                       (items_ptr) + copied,                                                       \
+                       amount * sizeof(**(self)->chunks));                                         \
+                copied += amount;                                                                  \
+                (self)->len += amount;                                                             \
+            }                                                                                      \
+        }                                                                                          \
+    } while (0)
 
-    if (self->end->len + size_word > self->end->cap) {
-        MEMPLUS_ASSERT(self->end->next == NULL);
-        size_t capacity = MP_REGION_DEFAULT_SIZE;
-        if (capacity < size_word) capacity = size_word;
-        self->end->next = mp_region_new(capacity);
-        if (self->end->next == NULL) return NULL;
-        self->end = self->end->next;
-    }
+/* Deletes the last item in the vector and returns it. The chunks are kept for reuse. */
+// self: SegVector*
+#define mp_segvec_pop(self) (--(self)->len, mp_segvec_get((self), (self)->len))
 
-    void *result = &self->end->data[self->end->len];
-    self->end->len += size_word;
-    self->len += size_word;
-    return result;
-}
+/* Sets the vector size to 0. The chunks are kept for reuse. */
+// self: SegVector*
+#define mp_segvec_clear(self)                                                                      \
+    do {                                                                                           \
+        (self)->len = 0;                                                                           \
+    } while (0)
 
-static void *mp_arena_realloc(mp_Arena *self, void *old_ptr, size_t old_size, size_t new_size) {
-    if (new_size <= old_size) return old_ptr;
-    void *new_ptr = mp_arena_alloc(self, new_size);
-    if (new_ptr == NULL) return NULL;
-    uint8_t *new_ptr_byte = (uint8_t *) new_ptr;
-    uint8_t *old_ptr_byte = (uint8_t *) old_ptr;
-    for (size_t i = 0; i < old_size; ++i) {
-        new_ptr_byte[i] = old_ptr_byte[i];
-    }
-    return new_ptr;
-}
+/* DEQUE
+ * Growable ring buffer with O(1) push and pop at both ends.
+ * The capacity is always a power of two so positions wrap with a mask.
+ * The items are stored in at most two contiguous segments: `mp_deque_first_len` items starting at
+ * `data + head` followed by `len - mp_deque_first_len` items starting at `data`. */
 
-static void *mp_arena_dup(mp_Arena *self, void *data, size_t size) {
-    void *dest = mp_arena_alloc(self, size);
-    if (dest == NULL) return NULL;
-    return memcpy(dest, data, size);
-}
+/* Starting capacity of a deque. Must be a power of two. You can adjust this to your liking. */
+#ifndef MP_DEQUE_INIT_CAPACITY
+#define MP_DEQUE_INIT_CAPACITY 64
+#endif
 
-static void mp_arena_free(mp_Arena *self, void *ptr) {
-    (void) self, (void) ptr;
-}
+/* Defines a deque struct given `name` and the data `type`. */
+// name: identifier
+// type: typename
+#define mp_deque_create(name, type)                                                                \
+    typedef struct {                                                                               \
+        mp_Allocator *alloc;                                                                       \
+        size_t        head;                                                                        \
+        size_t        len;                                                                         \
+        size_t        cap;                                                                         \
+        type         *data;                                                                        \
+    } name
 
-void mp_sarena_init(mp_SArena *self, size_t cap) {
-    uintptr_t *buffer = calloc(cap * sizeof(uintptr_t), 1);
-    self->buf         = buffer;
-    self->len         = 0;
-    self->cap         = cap;
-}
+/* Initializes a new deque and tell it to use `allocator`. */
+// self: Deque*
+// allocator: mp_Allocator*
+#define mp_deque_init(self, allocator)                                                             \
+    do {                                                                                           \
+        (self)->alloc = (allocator);                                                               \
+        (self)->head  = 0;                                                                         \
+        (self)->len   = 0;                                                                         \
+        (self)->cap   = 0;                                                                         \
+        (self)->data  = NULL;                                                                      \
+    } while (0)
 
-void mp_sarena_reset(mp_SArena *self) {
-    memset(self->buf, 0, self->cap);
-    self->len = 0;
-}
+/* Frees the deque. */
+// self: Deque*
+#define mp_deque_destroy(self)                                                                     \
+    do {                                                                                           \
+        mp_free((self)->alloc, (self)->data);                                                      \
+        (self)->alloc = NULL;                                                                      \
+        (self)->head  = 0;                                                                         \
+        (self)->len   = 0;                                                                         \
+        (self)->cap   = 0;                                                                         \
+        (self)->data  = NULL;                                                                      \
+    } while (0)
 
-void mp_sarena_destroy(mp_SArena *self) {
-    free(self->buf);
-    self->buf = NULL;
-    self->len = 0;
-    self->cap = 0;
-}
+/* Gets an item at index `i` counted from the front. */
+// self: Deque*
+// i: size_t
+#define mp_deque_get(self, i) (self)->data[((self)->head + (i)) & ((self)->cap - 1)]
 
-mp_Allocator mp_sarena_allocator(const mp_SArena *self) {
-    return mp_allocator_new(
-        self, mp_sarena_alloc, mp_sarena_realloc, mp_sarena_dup, mp_sarena_free);
-}
+/* Gets the first or the last item in the deque. */
+// self: Deque*
+#define mp_deque_first(self) mp_deque_get((self), 0)
+#define mp_deque_last(self)  mp_deque_get((self), (self)->len - 1)
 
-static void *mp_sarena_alloc(mp_SArena *self, size_t size) {
-    size_t size_word = (size + sizeof(uintptr_t) - 1) / sizeof(uintptr_t);
-    if (self->len + size_word > self->cap) return NULL;
-    void *result = &self->buf[self->len];
-    self->len += size_word;
-    return result;
-}
+/* Gets the amount of items in the segment starting at `data + head`. */
+// self: Deque*
+// -> size_t
+#define mp_deque_first_len(self)                                                                   \
+    ((self)->len < (self)->cap - (self)->head ? (self)->len : (self)->cap - (self)->head)
 
-static void *mp_sarena_realloc(mp_SArena *self, void *old_ptr, size_t old_size, size_t new_size) {
-    if (new_size <= old_size) return old_ptr;
-    void *new_ptr = mp_sarena_alloc(self, new_size);
-    if (new_ptr == NULL) return NULL;
-    uint8_t *new_ptr_byte = (uint8_t *) new_ptr;
-    uint8_t *old_ptr_byte = (uint8_t *) old_ptr;
-    for (size_t i = 0; i < old_size; ++i) {
-        new_ptr_byte[i] = old_ptr_byte[i];
-    }
-    return new_ptr;
-}
+/* Grows the capacity to the next power of two that is at least `new_cap`.
+ * The items are moved to the start of the new buffer.
+ * self.cap < new_cap if allocation failed, the deque is left untouched then. */
+// self: Deque*
+// new_cap: size_t
+#define mp_deque_reserve(self, new_cap)                                                            \
+    do {                                                                                           \
+        size_t mp_deque_cap_ = (self)->cap == 0 ? MP_DEQUE_INIT_CAPACITY : (self)->cap;            \
+        while (mp_deque_cap_ < (new_cap))                                                          \
+            mp_deque_cap_ *= 2;                                                                    \
+        if (mp_deque_cap_ > (self)->cap) {                                                         \
+            void *mp_deque_data_ = mp_alloc((self)->alloc, mp_deque_cap_ * sizeof(*(self)->data)); \
+            if (mp_deque_data_ != NULL) {                                                          \
+                if ((self)->len > 0) {                                                             \
+                    size_t mp_deque_first_ = mp_deque_first_len(self);                             \
+                    memcpy(mp_deque_data_,                                                         \
+                           (self)->data + (self)->head,                                            \
+                           mp_deque_first_ * sizeof(*(self)->data));                               \
+                    memcpy((uint8_t *) mp_deque_data_ + mp_deque_first_ * sizeof(*(self)->data),   \
+                           (self)->data,                                                           \
+                           ((self)->len - mp_deque_first_) * sizeof(*(self)->data));               \
+                }                                                                                  \
+                mp_free((self)->alloc, (self)->data);                                              \
+                (self)->data = mp_deque_data_;                                                     \
+                (self)->head = 0;                                                                  \
+                (self)->cap  = mp_deque_cap_;                                                      \
+            }                                                                                      \
+        }                                                                                          \
+    } while (0)
+
+/* Appends item to the back.
+ * self.len stays the same if allocation failed. */
+// self: Deque*
+// item: value of the same type as the deque data
+#define mp_deque_push_back(self, item)                                                             \
+    do {                                                                                           \
+        if ((self)->len == (self)->cap) mp_deque_reserve((self), (self)->len + 1);                 \
+        if ((self)->len < (self)->cap) {                                                           \
+            mp_deque_get((self), (self)->len) = (item);                                            \
+            ++(self)->len;                                                                         \
+        }                                                                                          \
+    } while (0)
+
+/* Prepends item to the front.
+ * self.len stays the same if allocation failed. */
+// self: Deque*
+// item: value of the same type as the deque data
+#define mp_deque_push_front(self, item)                                                            \
+    do {                                                                                           \
+        if ((self)->len == (self)->cap) mp_deque_reserve((self), (self)->len + 1);                 \
+        if ((self)->len < (self)->cap) {                                                           \
+            (self)->head               = ((self)->head - 1) & ((self)->cap - 1);                   \
+            (self)->data[(self)->head] = (item);                                                   \
+            ++(self)->len;                                                                         \
+        }                                                                                          \
+    } while (0)
+
+/* Deletes the last or the first item in the deque and returns it. */
+// self: Deque*
+#define mp_deque_pop_back(self) (--(self)->len, mp_deque_get((self), (self)->len))
+#define mp_deque_pop_front(self)                                                                   \
+    (--(self)->len,                                                                                \
+     (self)->head = ((self)->head + 1) & ((self)->cap - 1),                                        \
+     (self)->data[((self)->head - 1) & ((self)->cap - 1)])
+
+/* Appends items from `items_ptr` to the back with at most two memcpy.
+ * self.len stays the same if allocation failed. */
+// self: Deque*
+// items_ptr: pointer to the same type as the deque data
+// items_amount: size_t
+#define mp_deque_push_back_many(self, items_ptr, items_amount)                                     \
+    do {                                                                                           \
+        if ((self)->len + (items_amount) > (self)->cap)                                            \
+            mp_deque_reserve((self), (self)->len + (items_amount));                                \
+        if ((self)->len + (items_amount) <= (self)->cap) {                                         \
+            size_t mp_deque_tail_  = ((self)->head + (self)->len) & ((self)->cap - 1);             \
+            size_t mp_deque_first_ = (self)->cap - mp_deque_tail_;                                 \
+            if (mp_deque_first_ > (items_amount)) mp_deque_first_ = (items_amount);                \
+            memcpy((self)->data + mp_deque_tail_,                                                  \
+                   (items_ptr),                                                                    \
+                   mp_deque_first_ * sizeof(*(self)->data));                                       \
+            memcpy((self)->data,                                                                   \
+                   (items_ptr) + mp_deque_first_,                                                  \
+                   ((items_amount) - mp_deque_first_) * sizeof(*(self)->data));                    \
+            (self)->len += (items_amount);                                                         \
+        }                                                                                          \
+    } while (0)
+
+/* Deletes `amount` items from the front and writes them to `buf` with at most two memcpy. */
+// self: Deque*
+// buf: pointer to a buffer containing the same type as the deque data
+// amount: size_t
+#define mp_deque_pop_front_many(self, buf, amount)                                                 \
+    do {                                                                                           \
+        MEMPLUS_ASSERT((amount) <= (self)->len && "index out of bounds");                          \
+        size_t mp_deque_first_ = mp_deque_first_len(self);                                         \
+        if (mp_deque_first_ > (amount)) mp_deque_first_ = (amount);                                \
+        memcpy((buf), (self)->data + (self)->head, mp_deque_first_ * sizeof(*(self)->data));       \
+        memcpy((buf) + mp_deque_first_,                                                            \
+               (self)->data,                                                                       \
+               ((amount) - mp_deque_first_) * sizeof(*(self)->data));                              \
+        (self)->head = ((self)->head + (amount)) & ((self)->cap - 1);                              \
+        (self)->len -= (amount);                                                                   \
+    } while (0)
+
+/* Deletes `amount` items from the front without reading them,
+ * e.g. after handing the segments to I/O. */
+// self: Deque*
+// amount: size_t
+#define mp_deque_consume(self, amount)                                                             \
+    do {                                                                                           \
+        MEMPLUS_ASSERT((amount) <= (self)->len && "index out of bounds");                          \
+        if ((self)->cap > 0) (self)->head = ((self)->head + (amount)) & ((self)->cap - 1);         \
+        (self)->len -= (amount);                                                                   \
+    } while (0)
+
+/* Sets the deque size to 0. */
+// self: Deque*
+#define mp_deque_clear(self)                                                                       \
+    do {                                                                                           \
+        (self)->head = 0;                                                                          \
+        (self)->len  = 0;                                                                          \
+    } while (0)
+
+#ifndef MEMPLUS_NO_THREADS
+/* SINGLE PRODUCER SINGLE CONSUMER QUEUE
+ * Fixed capacity lock-free ring buffer for handing items from one thread to another.
+ * Only one thread may push and only one thread may pop at the same time.
+ * `head` and `tail` are free running counters on separate cache lines, each side keeps a cached
+ * copy of the other side's counter to avoid touching the shared cache line on every call. */
+
+/* Defines a queue `name` holding `type` and the following functions:
+ *     bool   name##_init(name *self, mp_Allocator *allocator, size_t cap);  // `cap` is rounded
+ *                                                                           // up to a power of 2
+ *     void   name##_destroy(name *self);
+ *     bool   name##_push(name *self, type item);     // Producer, false if the queue is full
+ *     bool   name##_pop(name *self, type *item);     // Consumer, false if the queue is empty
+ *     size_t name##_push_many(name *self, const type *items, size_t amount);
+ *     size_t name##_pop_many(name *self, type *buf, size_t amount);
+ * `*_many` functions copy as many items as possible with at most two memcpy and return the amount
+ * of items copied. */
+// name: identifier
+// type: typename
+#define mp_spsc_create(name, type)                                                                 \
+    typedef struct {                                                                               \
+        mp_Allocator  *alloc;                                                                      \
+        size_t         cap;                                                                        \
+        type          *data;                                                                       \
+        uint8_t        pad0[MP_CACHE_LINE_SIZE];                                                   \
+        atomic_size_t  head;          /* Written by the consumer */                                \
+        size_t         tail_cache;    /* The consumer's copy of `tail` */                          \
+        uint8_t        pad1[MP_CACHE_LINE_SIZE];                                                   \
+        atomic_size_t  tail;          /* Written by the producer */                                \
+        size_t         head_cache;    /* The producer's copy of `head` */                          \
+        uint8_t        pad2[MP_CACHE_LINE_SIZE];                                                   \
+    } name;                                                                                        \
+                                                                                                   \
+    static inline bool name##_init(name *self, mp_Allocator *allocator, size_t cap) {              \
+        size_t actual_cap = 1;                                                                     \
+        while (actual_cap < cap)                                                                   \
+            actual_cap *= 2;                                                                       \
+        self->data = mp_alloc(allocator, actual_cap * sizeof(type));                               \
+        if (self->data == NULL) return false;                                                      \
+        self->alloc      = allocator;                                                              \
+        self->cap        = actual_cap;                                                             \
+        self->tail_cache = 0;                                                                      \
+        self->head_cache = 0;                                                                      \
+        atomic_init(&self->head, 0);                                                               \
+        atomic_init(&self->tail, 0);                                                               \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    static inline void name##_destroy(name *self) {                                                \
+        mp_free(self->alloc, self->data);                                                          \
+        self->alloc = NULL;                                                                        \
+        self->cap   = 0;                                                                           \
+        self->data  = NULL;                                                                        \
+    }                                                                                              \
+                                                                                                   \
+    static inline size_t name##_push_many(name *self, const type *items, size_t amount) {          \
+        size_t tail = atomic_load_explicit(&self->tail, memory_order_relaxed);                     \
+        if (self->cap - (tail - self->head_cache) < amount)                                        \
+            self->head_cache = atomic_load_explicit(&self->head, memory_order_acquire);            \
+        size_t space = self->cap - (tail - self->head_cache);                                      \
+        if (amount > space) amount = space;                                                        \
+        size_t pos   = tail & (self->cap - 1);                                                     \
+        size_t first = self->cap - pos < amount ? self->cap - pos : amount;                        \
+        memcpy(self->data + pos, items, first * sizeof(type));                                     \
+        memcpy(self->data, items + first, (amount - first) * sizeof(type));                        \
+        atomic_store_explicit(&self->tail, tail + amount, memory_order_release);                   \
+        return amount;                                                                             \
+    }                                                                                              \
+                                                                                                   \
+    static inline size_t name##_pop_many(name *self, type *buf, size_t amount) {                   \
+        size_t head = atomic_load_explicit(&self->head, memory_order_relaxed);                     \
+        if (self->tail_cache - head < amount)                                                      \
+            self->tail_cache = atomic_load_explicit(&self->tail, memory_order_acquire);            \
+        size_t available = self->tail_cache - head;                                                \
+        if (amount > available) amount = available;                                                \
+        size_t pos   = head & (self->cap - 1);                                                     \
+        size_t first = self->cap - pos < amount ? self->cap - pos : amount;                        \
+        memcpy(buf, self->data + pos, first * sizeof(type));                                       \
+        memcpy(buf + first, self->data, (amount - first) * sizeof(type));                          \
+        atomic_store_explicit(&self->head, head + amount, memory_order_release);                   \
+        return amount;                                                                             \
+    }                                                                                              \
+                                                                                                   \
+    static inline bool name##_push(name *self, type item) {                                        \
+        size_t tail = atomic_load_explicit(&self->tail, memory_order_relaxed);                     \
+        if (tail - self->head_cache == self->cap) {                                                \
+            self->head_cache = atomic_load_explicit(&self->head, memory_order_acquire);            \
+            if (tail - self->head_cache == self->cap) return false;                                \
+        }                                                                                          \
+        self->data[tail & (self->cap - 1)] = item;                                                 \
+        atomic_store_explicit(&self->tail, tail + 1, memory_order_release);                        \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    static inline bool name##_pop(name *self, type *item) {                                        \
+        size_t head = atomic_load_explicit(&self->head, memory_order_relaxed);                     \
+        if (head == self->tail_cache) {                                                            \
+            self->tail_cache = atomic_load_explicit(&self->tail, memory_order_acquire);            \
+            if (head == self->tail_cache) return false;                                            \
+        }                                                                                          \
+        *item = self->data[head & (self->cap - 1)];                                                \
+        atomic_store_explicit(&self->head, head + 1, memory_order_release);                        \
+        return true;                                                                               \
+    }
+#endif /* ifndef MEMPLUS_NO_THREADS */
+
+/***********
+ * END OF VECTOR
+ ***********/
+
+/***********
+ * SORT
+ ***********/
+
+/* Partitions at or below this size are sorted with insertion sort. You can adjust this to your
+ * liking. */
+#ifndef MP_SORT_INSERTION_THRESHOLD
+#define MP_SORT_INSERTION_THRESHOLD 16
+#endif
+
+/* Default comparison used by the sort generator. */
+#define MP_LESS(a, b) ((a) < (b))
+
+/* Defines a type-specialized introsort named `name` for arrays of `type`.
+ * `less` is a function or function-like macro taking two values of `type` and returning true if
+ * the first one should be ordered before the second one.
+ * Defines the following functions:
+ *     void   name(type *data, size_t len);          // Sorts `data` (not stable)
+ *     size_t name##_unique(type *data, size_t len);  // Removes duplicates from sorted `data`,
+ *                                                    // returns the new length */
+// name: identifier
+// type: typename
+// less: identifier
+#define mp_sort_create(name, type, less)                                                           \
+    static inline void name##_insertion(type *data, size_t len) {                                  \
+        for (size_t i = 1; i < len; ++i) {                                                         \
+            type   item = data[i];                                                                 \
+            size_t j    = i;                                                                       \
+            for (; j > 0 && less(item, data[j - 1]); --j)                                          \
+                data[j] = data[j - 1];                                                             \
+            data[j] = item;                                                                        \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    static inline void name##_sift_down(type *data, size_t root, size_t len) {                     \
+        type item = data[root];                                                                    \
+        for (;;) {                                                                                 \
+            size_t child = 2 * root + 1;                                                           \
+            if (child >= len) break;                                                               \
+            if (child + 1 < len && less(data[child], data[child + 1])) ++child;                    \
+            if (!less(item, data[child])) break;                                                   \
+            data[root] = data[child];                                                              \
+            root       = child;                                                                    \
+        }                                                                                          \
+        data[root] = item;                                                                         \
+    }                                                                                              \
+                                                                                                   \
+    static inline void name##_heapsort(type *data, size_t len) {                                   \
+        for (size_t i = len / 2; i-- > 0;)                                                         \
+            name##_sift_down(data, i, len);                                                        \
+        for (size_t i = len; i-- > 1;) {                                                           \
+            type temp = data[0];                                                                   \
+            data[0]   = data[i];                                                                   \
+            data[i]   = temp;                                                                      \
+            name##_sift_down(data, 0, i);                                                          \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    static inline void name##_introsort(type *data, size_t len, size_t depth) {                    \
+        while (len > MP_SORT_INSERTION_THRESHOLD) {                                                \
+            if (depth == 0) {                                                                      \
+                name##_heapsort(data, len);                                                        \
+                return;                                                                            \
+            }                                                                                      \
+            --depth;                                                                               \
+                                                                                                   \
+            /* Median of three, the lesser and the greater one also act as sentinels. */           \
+            type temp, *a = &data[1], *b = &data[len / 2], *c = &data[len - 1];                    \
+            if (less(*b, *a)) temp = *a, *a = *b, *b = temp;                                       \
+            if (less(*c, *b)) {                                                                    \
+                temp = *b, *b = *c, *c = temp;                                                     \
+                if (less(*b, *a)) temp = *a, *a = *b, *b = temp;                                   \
+            }                                                                                      \
+            temp = data[0], data[0] = *b, *b = temp;                                               \
+                                                                                                   \
+            type   pivot = data[0];                                                                \
+            size_t i = 1, j = len - 1;                                                             \
+            for (;;) {                                                                             \
+                do ++i;                                                                            \
+                while (less(data[i], pivot));                                                      \
+                do --j;                                                                            \
+                while (less(pivot, data[j]));                                                      \
+                if (i >= j) break;                                                                 \
+                temp = data[i], data[i] = data[j], data[j] = temp;                                 \
+            }                                                                                      \
+            data[0] = data[j], data[j] = pivot;                                                    \
+                                                                                                   \
+            /* Recurse into the smaller half to bound the stack depth. */                          \
+            if (j < len - j - 1) {                                                                 \
+                name##_introsort(data, j, depth);                                                  \
+                data += j + 1;                                                                     \
+                len -= j + 1;                                                                      \
+            } else {                                                                               \
+                name##_introsort(data + j + 1, len - j - 1, depth);                                \
+                len = j;                                                                           \
+            }                                                                                      \
+        }                                                                                          \
+        name##_insertion(data, len);                                                               \
+    }                                                                                              \
+                                                                                                   \
+    static inline void name(type *data, size_t len) {                                              \
+        size_t depth = 0;                                                                          \
+        for (size_t n = len; n > 1; n >>= 1)                                                       \
+            depth += 2;                                                                            \
+        name##_introsort(data, len, depth);                                                        \
+    }                                                                                              \
+                                                                                                   \
+    static inline size_t name##_unique(type *data, size_t len) {                                   \
+        if (len == 0) return 0;                                                                    \
+        size_t result = 1;                                                                         \
+        for (size_t i = 1; i < len; ++i)                                                           \
+            if (less(data[result - 1], data[i])) data[result++] = data[i];                         \
+        return result;                                                                             \
+    }
+
+/* Sorts the vector with a sort function defined by `mp_sort_create`. */
+// self: Vector*
+// sort_name: identifier
+#define mp_sort(self, sort_name) sort_name((self)->data, (self)->len)
+
+/* Sorts the vector and removes duplicated items in place. */
+// self: Vector*
+// sort_name: identifier
+#define mp_sort_unique(self, sort_name)                                                            \
+    do {                                                                                           \
+        sort_name((self)->data, (self)->len);                                                      \
+        (self)->len = sort_name##_unique((self)->data, (self)->len);                               \
+    } while (0)
+
+/* LSD radix sort for integer and floating point keys.
+ * Scratch space of the same size as `data` is taken from `scratch` (e.g. an `mp_Temp`) and freed
+ * before returning. Returns false if the scratch allocation failed, `data` is untouched then.
+ * The sort is stable. Negative zero is ordered before positive zero and NaNs are ordered by their
+ * sign and bit pattern. */
+bool mp_radix_sort_u32(uint32_t *data, size_t len, const mp_Allocator *scratch);
+bool mp_radix_sort_u64(uint64_t *data, size_t len, const mp_Allocator *scratch);
+bool mp_radix_sort_i32(int32_t *data, size_t len, const mp_Allocator *scratch);
+bool mp_radix_sort_i64(int64_t *data, size_t len, const mp_Allocator *scratch);
+bool mp_radix_sort_f32(float *data, size_t len, const mp_Allocator *scratch);
+bool mp_radix_sort_f64(double *data, size_t len, const mp_Allocator *scratch);
+/* Stable LSD radix sort for `len` items of `size` bytes each, ordered by the key returned by `key`.
+ * `key` is called once per item. Requires 32 * `len` + `size` * `len` bytes of scratch space. */
+bool mp_radix_sort_key(void               *data,
+                       size_t              len,
+                       size_t              size,
+                       uint64_t            (*key)(const void *item),
+                       const mp_Allocator *scratch);
+
+/* Radix sorts the vector. `suffix` is one of u32, u64, i32, i64, f32, f64 and must match the type
+ * of the vector data. Evaluates to false if the scratch allocation failed. */
+// self: Vector*
+// suffix: identifier
+// scratch: mp_Allocator*
+#define mp_radix_sort(self, suffix, scratch)                                                       \
+    mp_radix_sort_##suffix((self)->data, (self)->len, (scratch))
+
+/***********
+ * END OF SORT
+ ***********/
+
+/***********
+ * BITSET
+ ***********/
+
+/* Packed vector of bits stored in 64-bit words.
+ * `alloc`, `len`, `cap` and `data` follow the vector layout with `len` and `cap` counted in words,
+ * so the words grow with `mp_resize` like any other vector. Bits past `bits` in the last word are
+ * always zero.
+ * Counting uses the popcount instruction when the target supports it (e.g. -mpopcnt).
+ * Bulk operations use SSE2 or AVX2 when the target supports it. */
+typedef struct {
+    mp_Allocator *alloc;
+    size_t        len;     // The amount of words used
+    size_t        cap;     // The amount of words allocated
+    uint64_t     *data;    // The words
+    size_t        bits;    // The amount of bits
+} mp_Bitset;
+
+/* Initializes a new empty bitset and tell it to use `allocator`. */
+void mp_bitset_init(mp_Bitset *self, mp_Allocator *allocator);
+/* Frees the bitset. */
+void mp_bitset_destroy(mp_Bitset *self);
+/* Changes the amount of bits. New bits are cleared.
+ * Returns false and sets self.data == NULL if allocation failed. */
+bool mp_bitset_resize(mp_Bitset *self, size_t bits);
+/* Sets every bit to `value`. */
+void mp_bitset_fill(mp_Bitset *self, bool value);
+/* Word-wise operations, the result is written to `self`.
+ * Both bitsets must have the same amount of bits. */
+void mp_bitset_and(mp_Bitset *self, const mp_Bitset *other);
+void mp_bitset_or(mp_Bitset *self, const mp_Bitset *other);
+void mp_bitset_xor(mp_Bitset *self, const mp_Bitset *other);
+// self = self & ~other
+void mp_bitset_andnot(mp_Bitset *self, const mp_Bitset *other);
+/* Returns the amount of set bits. */
+size_t mp_bitset_count(const mp_Bitset *self);
+/* Returns the amount of set bits before index `i`. */
+size_t mp_bitset_rank(const mp_Bitset *self, size_t i);
+/* Returns the index of the first set bit at or after `i`, or self.bits if there is none. */
+size_t mp_bitset_find_next(const mp_Bitset *self, size_t i);
+
+/* Sets, clears, or gets the bit at index `i`. */
+// self: mp_Bitset*
+// i: size_t
+#define mp_bitset_set(self, i)   ((self)->data[(i) >> 6] |= (uint64_t) 1 << ((i) & 63))
+#define mp_bitset_clear(self, i) ((self)->data[(i) >> 6] &= ~((uint64_t) 1 << ((i) & 63)))
+// -> bool
+#define mp_bitset_test(self, i)  ((bool) (((self)->data[(i) >> 6] >> ((i) & 63)) & 1))
+
+/***********
+ * END OF BITSET
+ ***********/
+
+/***********
+ * SNAPSHOT
+ ***********/
+
+/* RELATIVE POINTER
+ * Stores the distance from its own address to the target instead of the address of the target,
+ * so a structure made of relative pointers stays valid when the memory holding it is moved, saved
+ * to a file or mapped at another address. The pointer and its target must be in the same block of
+ * memory, e.g. the same `mp_SArena`. An offset of 0 means NULL. */
+typedef struct {
+    ptrdiff_t offset;
+} mp_RelPtr;
+
+/* Returns the target of `self` or NULL. */
+static inline void *mp_relptr_get(const mp_RelPtr *self) {
+    if (self->offset == 0) return NULL;
+    return (char *) self + self->offset;
+}
+
+/* Points `self` to `ptr`, which may be NULL. */
+static inline void mp_relptr_set(mp_RelPtr *self, const void *ptr) {
+    self->offset = ptr ? (const char *) ptr - (const char *) self : 0;
+}
+
+/* RELATIVE STRING
+ * `mp_String` that can be stored in a snapshot. */
+typedef struct {
+    size_t    len;
+    mp_RelPtr cstr;
+} mp_RelString;
+
+/* Copies `str` and a null-terminator into `allocator` and points `self` to the copy.
+ * Returns false if allocation failed. */
+bool mp_relstring_init(mp_RelString *self, const mp_Allocator *allocator, mp_Slice str);
+/* Returns the string as an `mp_String`. It must not be modified if it is in a mapped snapshot. */
+mp_String mp_relstring_get(const mp_RelString *self);
+
+/* RELATIVE VECTOR
+ * Fixed size vector that can be stored in a snapshot. Build the items with a regular vector in any
+ * allocator, then copy them into the snapshot arena. */
+
+/* Defines a vector `name` holding `type` and the following functions:
+ *     bool  name##_init(name *self, const mp_Allocator *allocator, const type *items, size_t len);
+ *     type *name##_data(const name *self);
+ *     type  name##_get(const name *self, size_t index);
+ * `*_init` copies `len` items into `allocator`, or only allocates room for them if `items` is
+ * NULL, and returns false if allocation failed.
+ * Copying relative pointers breaks them, so items holding relative pointers must be allocated with
+ * `items` == NULL and filled in place. */
+// name: identifier
+// type: typename
+#define mp_relvector_create(name, type)                                                            \
+    typedef struct {                                                                               \
+        size_t    len;                                                                             \
+        mp_RelPtr data;                                                                            \
+    } name;                                                                                        \
+                                                                                                   \
+    static inline bool name##_init(                                                                \
+        name *self, const mp_Allocator *allocator, const type *items, size_t len) {                \
+        type *data = NULL;                                                                         \
+        if (len > 0) {                                                                             \
+            data = items ? mp_dup(allocator, (void *) items, len * sizeof(type))                   \
+                         : mp_alloc(allocator, len * sizeof(type));                                \
+            if (data == NULL) return false;                                                        \
+        }                                                                                          \
+        self->len = len;                                                                           \
+        mp_relptr_set(&self->data, data);                                                          \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    static inline type *name##_data(const name *self) {                                            \
+        return (type *) mp_relptr_get(&self->data);                                                \
+    }                                                                                              \
+                                                                                                   \
+    static inline type name##_get(const name *self, size_t index) {                                \
+        MEMPLUS_ASSERT(index < self->len && "index out of bounds");                                \
+        return name##_data(self)[index];                                                           \
+    }
+
+/* SNAPSHOT
+ * The used part of an `mp_SArena` saved to a file and mapped back read-only without any
+ * deserialization. Everything inside must point to each other with relative pointers and the
+ * first allocation in the arena is the root to start from. A snapshot can only be loaded on a
+ * machine with the same word size, endianness and structure layout as the one that saved it.
+ * The file is mapped at a page boundary and the data follows a header of `MP_SNAPSHOT_ALIGN` bytes,
+ * so the root is aligned to `MP_SNAPSHOT_ALIGN`. That is at least the alignment of the arena's
+ * buffer from calloc (`max_align_t`) and the default `MP_SOA_ALIGN`. */
+#define MP_SNAPSHOT_MAGIC   "MPSNAPSH"
+#define MP_SNAPSHOT_VERSION 2
+#define MP_SNAPSHOT_ALIGN   64
+
+/* The start of a snapshot file, followed by the data. */
+typedef struct {
+    char     magic[8];                            // `MP_SNAPSHOT_MAGIC`
+    uint32_t version;                             // `MP_SNAPSHOT_VERSION`
+    uint32_t word_size;                           // sizeof(uintptr_t) of the saving machine
+    uint64_t len;                                 // The size of the data in bytes
+    uint64_t checksum;                            // `mp_hash` of the data
+    uint8_t  reserved[MP_SNAPSHOT_ALIGN - 32];    // Pads the header to `MP_SNAPSHOT_ALIGN` bytes
+} mp_SnapshotHeader;
+
+/* Saves the used part of `arena` to `file_path`.
+ * Returns false if failed and sets errno through stdlib functions. */
+bool mp_snapshot_save(const mp_SArena *arena, const char *file_path);
+
+#ifdef MEMPLUS_POSIX
+typedef struct {
+    mp_Slice    map;     // The whole mapped file
+    const void *data;    // The data of the arena
+    size_t      len;     // The size of the data in bytes
+} mp_Snapshot;
+
+/* Maps a snapshot saved by `mp_snapshot_save` read-only. Checks the header, and the checksum of
+ * the data if `verify` is true, which reads the whole file.
+ * Returns false if failed and sets errno through stdlib functions, or to EINVAL if the file is not
+ * a valid snapshot. */
+bool mp_snapshot_load(mp_Snapshot *self, const char *file_path, bool verify);
+/* Unmaps a snapshot. Pointers into it are invalid afterwards. */
+void mp_snapshot_unload(mp_Snapshot *self);
+
+/* Returns the first allocation of the saved arena. */
+// self: mp_Snapshot*
+// type: typename
+// -> const `type`*
+#define mp_snapshot_root(self, type) ((const type *) (self)->data)
+#endif /* ifdef MEMPLUS_POSIX */
+
+/***********
+ * END OF SNAPSHOT
+ ***********/
+
+/**********
+ * MISCELLANEOUS
+ **********/
+
+/* Returns the index of the highest set bit in `x`. `x` must not be 0. */
+static inline size_t mp_log2(size_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return sizeof(unsigned long long) * 8 - 1 - __builtin_clzll(x);
+#else
+    size_t result = 0;
+    while (x >>= 1)
+        ++result;
+    return result;
+#endif
+}
+
+/* Returns the amount of set bits in `x`. */
+static inline size_t mp_popcount64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & UINT64_C(0x5555555555555555));
+    x = (x & UINT64_C(0x3333333333333333)) + ((x >> 2) & UINT64_C(0x3333333333333333));
+    x = (x + (x >> 4)) & UINT64_C(0x0f0f0f0f0f0f0f0f);
+    return (x * UINT64_C(0x0101010101010101)) >> 56;
+#endif
+}
+
+/* Returns the index of the lowest set bit in `x`. `x` must not be 0. */
+static inline size_t mp_ctz64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(x);
+#else
+    size_t result = 0;
+    while ((x & 1) == 0) {
+        x >>= 1;
+        ++result;
+    }
+    return result;
+#endif
+}
+
+/* Returns the low half of `a * b` and stores the high half in `hi`. */
+static inline uint64_t mp_umul128(uint64_t a, uint64_t b, uint64_t *hi) {
+#ifdef __SIZEOF_INT128__
+    __uint128_t r = (__uint128_t) a * b;
+    *hi           = (uint64_t) (r >> 64);
+    return (uint64_t) r;
+#else
+    uint64_t ha = a >> 32, hb = b >> 32, la = (uint32_t) a, lb = (uint32_t) b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t  = rl + (rm0 << 32);
+    uint64_t lo = t + (rm1 << 32);
+    *hi         = rh + (rm0 >> 32) + (rm1 >> 32) + (t < rl) + (lo < t);
+    return lo;
+#endif
+}
+
+/* Reads and allocates the content in `file_path` and return it to `output`.
+ * The content is read directly into a buffer from `allocator` and may contain null bytes,
+ * `output.len` is the size of the file. A null-terminator is appended after the content.
+ * Returns false if failed and sets errno through stdlib functions. */
+bool mp_read_entire_file(mp_Allocator *allocator, mp_String *output, const char *file_path);
+
+/* Default size of the buffer of a file reader in bytes. You can adjust this to your liking. */
+#ifndef MP_FILE_READER_BUFFER_SIZE
+#define MP_FILE_READER_BUFFER_SIZE (64 * 1024)
+#endif
+
+/* Reads a file in records through a fixed buffer, so files larger than memory can be processed.
+ * Records are found with memchr and returned as slices into the buffer without copying. They stay
+ * valid until the next call on the reader. A record that straddles the end of the buffer is moved
+ * to the front before refilling, and the buffer only grows (doubling) when a single record does
+ * not fit in it, so nothing is allocated in steady state. */
+typedef struct {
+    mp_Allocator *alloc;
+    FILE         *file;
+    bool          owns_file;    // Whether the file is closed by `mp_file_reader_close`
+    bool          eof;          // Whether the end of the file has been reached
+    bool          error;        // Whether reading or allocating failed
+    size_t        begin;        // Start of the unread data in `buf`
+    size_t        scanned;      // End of the data already searched for the delimiter
+    size_t        end;          // End of the data in `buf`
+    size_t        cap;          // Size of `buf`
+    char         *buf;
+} mp_FileReader;
+
+/* Initializes a reader for an open `file` with a buffer of `buffer_size` bytes from `allocator`.
+ * `buffer_size` 0 uses `MP_FILE_READER_BUFFER_SIZE`. The file is not closed by the reader.
+ * Returns false if allocation failed. */
+bool mp_file_reader_init(mp_FileReader *self,
+                         mp_Allocator  *allocator,
+                         FILE          *file,
+                         size_t         buffer_size);
+/* Same as `mp_file_reader_init` but opens `file_path` for the reader.
+ * Returns false if failed and sets errno through stdlib functions. */
+bool mp_file_reader_open(mp_FileReader *self,
+                         mp_Allocator  *allocator,
+                         const char    *file_path,
+                         size_t         buffer_size);
+/* Frees the buffer and closes the file if it was opened by the reader. */
+void mp_file_reader_close(mp_FileReader *self);
+/* Reads the next record ending with `delim` (excluded) to `record`. The last record does not need
+ * to end with `delim`. Returns false when there are no more records or reading failed, check
+ * self.error to tell them apart. Once reading failed, the partial record after the last `delim`
+ * is not returned since its content may be cut short. */
+bool mp_file_reader_next(mp_FileReader *self, char delim, mp_Slice *record);
+/* Same as `mp_file_reader_next` with '\n' as the delimiter. A trailing '\r' is also removed. */
+bool mp_file_reader_next_line(mp_FileReader *self, mp_Slice *line);
+
+#if defined(MEMPLUS_POSIX) && !defined(MEMPLUS_NO_THREADS)
+/* Maximum amount of threads used by `mp_read_files` when it picks the amount itself.
+ * You can adjust this to your liking. */
+#ifndef MP_READ_FILES_MAX_THREADS
+#define MP_READ_FILES_MAX_THREADS 8
+#endif
+
+/* Reads `amount` files from `file_paths` concurrently and writes their content to `outputs`.
+ * Each worker thread reads files with `mp_read_entire_file` directly into buffers from `allocator`,
+ * sized up front from the file size. Calls to `allocator` are serialized by a mutex, so it does not
+ * need to be thread-safe.
+ * `threads` 0 uses one thread per online CPU, up to `MP_READ_FILES_MAX_THREADS`.
+ * `errors[i]` is set to 0 if file i was read or to its errno value if it failed, outputs[i].cstr
+ * is NULL then. Returns the amount of files that failed. */
+size_t mp_read_files(mp_Allocator      *allocator,
+                     const char *const *file_paths,
+                     size_t             amount,
+                     mp_String         *outputs,
+                     int               *errors,
+                     size_t             threads);
+#endif
+
+#ifdef MEMPLUS_POSIX
+/* Hints for `mp_map_file`. They do nothing if the system headers do not declare `posix_madvise`,
+ * e.g. when compiling with -std=c11 without defining _POSIX_C_SOURCE. */
+#define MP_MAP_SEQUENTIAL (1 << 0)    // The content will be read from start to end
+#define MP_MAP_WILLNEED   (1 << 1)    // The content will be read soon, start reading it ahead
+
+/* Maps the content in `file_path` to memory as read-only and return it to `output` without copying.
+ * `hints` is a combination of `MP_MAP_*` flags or 0. An empty file gives output.ptr == NULL.
+ * The content is not null-terminated. Free it with `mp_unmap_file`.
+ * Returns false if failed and sets errno through stdlib functions. */
+bool mp_map_file(mp_Slice *output, const char *file_path, int hints);
+/* Unmaps a file mapped by `mp_map_file`. */
+void mp_unmap_file(mp_Slice *map);
+#endif /* ifdef MEMPLUS_POSIX */
+
+/**********
+ * END OF MISCELLANEOUS
+ **********/
+
+/***********
+ * IMPLEMENTATION
+ ***********/
+
+#ifdef MEMPLUS_IMPLEMENTATION
+
+#ifdef MEMPLUS_POSIX
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/* Without -mavx2, GCC and Clang on x86-64 still compile AVX2 versions of the string search kernels
+ * and pick them at run time if the CPU supports AVX2. */
+#if !defined(__AVX2__) && defined(__SSE2__) && defined(__x86_64__) &&                              \
+    (defined(__GNUC__) || defined(__clang__))
+#define MP_AVX2_DISPATCH
+#define MP_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define MP_TARGET_AVX2
+#endif
+
+#if defined(__AVX2__) || defined(MP_AVX2_DISPATCH)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* Functions that are used by `mp_*_new_allocator` to define the allocator. */
+static void *mp_arena_alloc(mp_Arena *self, size_t size);
+static void *mp_arena_realloc(mp_Arena *self, void *old_ptr, size_t old_size, size_t new_size);
+static void *mp_arena_dup(mp_Arena *self, void *data, size_t size);
+static void  mp_arena_free(mp_Arena *self, void *ptr);
+
+static void *mp_sarena_alloc(mp_SArena *self, size_t size);
+static void *mp_sarena_realloc(mp_SArena *self, void *old_ptr, size_t old_size, size_t new_size);
+static void *mp_sarena_dup(mp_SArena *self, void *data, size_t size);
+static void  mp_sarena_free(mp_SArena *self, void *ptr);
+
+static void *mp_heap_alloc(void *self, size_t size);
+static void *mp_heap_realloc(void *self, void *old_ptr, size_t old_size, size_t new_size);
+static void *mp_heap_dup(void *self, void *data, size_t size);
+static void  mp_heap_free(void *self, void *ptr);
+
+mp_Region *mp_region_new(size_t cap) {
+    size_t     bytes  = sizeof(mp_Region) + sizeof(uintptr_t) * cap;
+    mp_Region *region = calloc(bytes, 1);
+    region->next      = NULL;
+    region->len       = 0;
+    region->cap       = cap;
+    return region;
+}
+
+void mp_region_free(mp_Region *self) {
+    free(self);
+}
+
+void mp_arena_init(mp_Arena *self) {
+    self->len   = 0;
+    self->begin = NULL;
+    self->end   = NULL;
+}
+
+void mp_arena_destroy(mp_Arena *self) {
+    mp_Region *region = self->begin;
+    while (region) {
+        mp_Region *region_temp = region;
+        region                 = region->next;
+        mp_region_free(region_temp);
+    }
+    self->begin = NULL;
+    self->end   = NULL;
+}
+
+mp_Allocator mp_arena_allocator(const mp_Arena *self) {
+    return mp_allocator_new(self, mp_arena_alloc, mp_arena_realloc, mp_arena_dup, mp_arena_free);
+}
+
+static void *mp_arena_alloc(mp_Arena *self, size_t size) {
+    // size in words
+    size_t size_word = (size + sizeof(uintptr_t) - 1) / sizeof(uintptr_t);
+
+    if (self->end == NULL) {
+        MEMPLUS_ASSERT(self->begin == NULL);
+        size_t capacity = MP_REGION_DEFAULT_SIZE;
+        if (capacity < size_word) capacity = size_word;
+        self->end = mp_region_new(capacity);
+        if (self->end == NULL) return NULL;
+        self->begin = self->end;
+    }
+
+    while (self->end->len + size_word > self->end->cap && self->end->next != NULL) {
+        self->end = self->end->next;
+    }
+
+    if (self->end->len + size_word > self->end->cap) {
+        MEMPLUS_ASSERT(self->end->next == NULL);
+        size_t capacity = MP_REGION_DEFAULT_SIZE;
+        if (capacity < size_word) capacity = size_word;
+        self->end->next = mp_region_new(capacity);
+        if (self->end->next == NULL) return NULL;
+        self->end = self->end->next;
+    }
+
+    void *result = &self->end->data[self->end->len];
+    self->end->len += size_word;
+    self->len += size_word;
+    return result;
+}
+
+static void *mp_arena_realloc(mp_Arena *self, void *old_ptr, size_t old_size, size_t new_size) {
+    if (new_size <= old_size) return old_ptr;
+
+    // Extends the last allocation in place if the region has room for it
+    size_t old_size_word = (old_size + sizeof(uintptr_t) - 1) / sizeof(uintptr_t);
+    size_t new_size_word = (new_size + sizeof(uintptr_t) - 1) / sizeof(uintptr_t);
+    if (old_ptr != NULL && self->end != NULL &&
+        (uintptr_t *) old_ptr + old_size_word == &self->end->data[self->end->len] &&
+        self->end->len - old_size_word + new_size_word <= self->end->cap) {
+        self->end->len += new_size_word - old_size_word;
+        self->len += new_size_word - old_size_word;
+        return old_ptr;
+    }
+
+    void *new_ptr = mp_arena_alloc(self, new_size);
+    if (new_ptr == NULL) return NULL;
+    if (old_size > 0) memcpy(new_ptr, old_ptr, old_size);
+    return new_ptr;
+}
+
+static void *mp_arena_dup(mp_Arena *self, void *data, size_t size) {
+    void *dest = mp_arena_alloc(self, size);
+    if (dest == NULL) return NULL;
+    return memcpy(dest, data, size);
+}
+
+static void mp_arena_free(mp_Arena *self, void *ptr) {
+    (void) self, (void) ptr;
+}
+
+void mp_sarena_init(mp_SArena *self, size_t cap) {
+    uintptr_t *buffer = calloc(cap * sizeof(uintptr_t), 1);
+    self->buf         = buffer;
+    self->len         = 0;
+    self->cap         = cap;
+}
+
+void mp_sarena_reset(mp_SArena *self) {
+    memset(self->buf, 0, self->cap);
+    self->len = 0;
+}
+
+void mp_sarena_destroy(mp_SArena *self) {
+    free(self->buf);
+    self->buf = NULL;
+    self->len = 0;
+    self->cap = 0;
+}
+
+mp_Allocator mp_sarena_allocator(const mp_SArena *self) {
+    return mp_allocator_new(
+        self, mp_sarena_alloc, mp_sarena_realloc, mp_sarena_dup, mp_sarena_free);
+}
+
+static void *mp_sarena_alloc(mp_SArena *self, size_t size) {
+    size_t size_word = (size + sizeof(uintptr_t) - 1) / sizeof(uintptr_t);
+    if (self->len + size_word > self->cap) return NULL;
+    void *result = &self->buf[self->len];
+    self->len += size_word;
+    return result;
+}
+
+static void *mp_sarena_realloc(mp_SArena *self, void *old_ptr, size_t old_size, size_t new_size) {
+    if (new_size <= old_size) return old_ptr;
+
+    // Extends the last allocation in place if the arena has room for it
+    size_t old_size_word = (old_size + sizeof(uintptr_t) - 1) / sizeof(uintptr_t);
+    size_t new_size_word = (new_size + sizeof(uintptr_t) - 1) / sizeof(uintptr_t);
+    if (old_ptr != NULL && (uintptr_t *) old_ptr + old_size_word == &self->buf[self->len]) {
+        if (self->len - old_size_word + new_size_word > self->cap) return NULL;
+        self->len += new_size_word - old_size_word;
+        return old_ptr;
+    }
+
+    void *new_ptr = mp_sarena_alloc(self, new_size);
+    if (new_ptr == NULL) return NULL;
+    if (old_size > 0) memcpy(new_ptr, old_ptr, old_size);
+    return new_ptr;
+}
+
+static void *mp_sarena_dup(mp_SArena *self, void *data, size_t size) {
+    void *buf = mp_sarena_alloc(self, size);
+    if (buf == NULL) return NULL;
+    return memcpy(buf, data, size);
+}
+
+static void mp_sarena_free(mp_SArena *self, void *ptr) {
+    (void) self, (void) ptr;
+}
+
+void mp_temp_init_size(mp_Temp *self, void *buffer, size_t cap) {
+    memset(buffer, 0, cap);
+    self->buf = buffer;
+    self->len = 0;
+    self->cap = cap / sizeof(uintptr_t);
+}
+
+void mp_temp_reset(mp_Temp *self) {
+    memset(self->buf, 0, self->cap);
+    self->len = 0;
+}
+
+mp_Allocator mp_temp_allocator(const mp_Temp *self) {
+    return mp_allocator_new(
+        self, mp_sarena_alloc, mp_sarena_realloc, mp_sarena_dup, mp_sarena_free);
+}
+
+mp_Allocator mp_heap_allocator(void) {
+    return mp_allocator_new(NULL, mp_heap_alloc, mp_heap_realloc, mp_heap_dup, mp_heap_free);
+}
+
+static void *mp_heap_alloc(void *self, size_t size) {
+    (void) self;
+    return calloc(size, 1);
+}
+
+static void *mp_heap_realloc(void *self, void *old_ptr, size_t old_size, size_t new_size) {
+    (void) self;
+    if (new_size <= old_size) return old_ptr;
+    return realloc(old_ptr, new_size);
+}
+
+static void *mp_heap_dup(void *self, void *data, size_t size) {
+    (void) self;
+    void *buf = mp_heap_alloc(self, size);
+    if (buf == NULL) return NULL;
+    return memcpy(buf, data, size);
+}
+
+static void mp_heap_free(void *self, void *ptr) {
+    (void) self;
+    free(ptr);
+}
+
+#if defined(MEMPLUS_POSIX) && !defined(MEMPLUS_NO_THREADS) && defined(__STDC_VERSION__) &&         \
+    __STDC_VERSION__ >= 201112L
+// Keeps the data of every block aligned to 16 bytes
+#define MP_THREAD_HEAP_HEADER_SIZE 16
+
+static inline size_t mp_thread_heap_block_size(size_t size_class) {
+    return (size_t) 32 << size_class;
+}
+
+static inline void mp_heap_block_push(mp_HeapBlockList *list, mp_HeapBlock *block) {
+    block->link.next = list->head;
+    list->head       = block;
+    ++list->len;
+}
+
+/* Moves up to `amount` blocks from `src` to `dst`. */
+static void mp_heap_block_move(mp_HeapBlockList *dst, mp_HeapBlockList *src, size_t amount) {
+    for (size_t i = 0; i < amount && src->head != NULL; ++i) {
+        mp_HeapBlock *block = src->head;
+        src->head           = block->link.next;
+        --src->len;
+        mp_heap_block_push(dst, block);
+    }
+}
+
+/* Gives the free blocks of an exiting thread back to the global pool and keeps the cache for the
+ * next thread. Called by pthread when a thread that used the allocator exits. */
+static void mp_thread_cache_release(void *ptr) {
+    mp_ThreadCache *cache = ptr;
+    mp_ThreadHeap  *heap  = cache->heap;
+    pthread_mutex_lock(&heap->lock);
+    for (size_t i = 0; i < MP_THREAD_HEAP_CLASSES; ++i)
+        mp_heap_block_move(&heap->free[i], &cache->free[i], cache->free[i].len);
+    cache->next_idle = heap->idle;
+    heap->idle       = cache;
+    pthread_mutex_unlock(&heap->lock);
+}
+
+/* Returns the cache of the current thread, taking an idle one or creating one if needed. */
+static mp_ThreadCache *mp_thread_cache_get(mp_ThreadHeap *self) {
+    mp_ThreadCache *cache = pthread_getspecific(self->key);
+    if (cache != NULL) return cache;
+
+    pthread_mutex_lock(&self->lock);
+    cache = self->idle;
+    if (cache != NULL) {
+        self->idle = cache->next_idle;
+    } else {
+        cache = calloc(1, sizeof(mp_ThreadCache));
+        if (cache != NULL) {
+            cache->heap  = self;
+            cache->next  = self->caches;
+            self->caches = cache;
+        }
+    }
+    pthread_mutex_unlock(&self->lock);
+
+    if (cache != NULL && pthread_setspecific(self->key, cache) != 0) {
+        mp_thread_cache_release(cache);
+        return NULL;
+    }
+    return cache;
+}
+
+/* Takes the blocks other threads freed into the free lists of the cache. */
+static void mp_thread_cache_collect(mp_ThreadCache *self) {
+    if (atomic_load_explicit(&self->remote, memory_order_relaxed) == NULL) return;
+    mp_HeapBlock *block = atomic_exchange_explicit(&self->remote, NULL, memory_order_acquire);
+    while (block != NULL) {
+        mp_HeapBlock *next = block->link.next;
+        mp_heap_block_push(&self->free[block->size_class], block);
+        block = next;
+    }
+}
+
+/* Moves a batch of blocks from the global pool to the cache, allocating a new slab if the pool is
+ * empty. */
+static bool mp_thread_cache_refill(mp_ThreadCache *self, size_t size_class) {
+    mp_ThreadHeap    *heap = self->heap;
+    mp_HeapBlockList *pool = &heap->free[size_class];
+    bool              result = true;
+    pthread_mutex_lock(&heap->lock);
+
+    if (pool->head == NULL) {
+        size_t   block_size = mp_thread_heap_block_size(size_class);
+        size_t   amount     = MP_THREAD_HEAP_SLAB_SIZE / block_size;
+        uint8_t *slab       = malloc(MP_THREAD_HEAP_HEADER_SIZE + amount * block_size);
+        if (slab == NULL) return_defer(false);
+        *(void **) slab = heap->slabs;
+        heap->slabs     = slab;
+        for (size_t i = amount; i-- > 0;) {
+            mp_HeapBlock *block =
+                (mp_HeapBlock *) (slab + MP_THREAD_HEAP_HEADER_SIZE + i * block_size);
+            block->size_class = size_class;
+            mp_heap_block_push(pool, block);
+        }
+    }
+    mp_heap_block_move(&self->free[size_class], pool, MP_THREAD_HEAP_BATCH);
+
+defer:
+    pthread_mutex_unlock(&heap->lock);
+    return result;
+}
+
+/* Returns an uninitialized block with room for `size` bytes. */
+static void *mp_thread_heap_take(mp_ThreadHeap *self, size_t size) {
+    if (size > mp_thread_heap_block_size(MP_THREAD_HEAP_CLASSES - 1) - MP_THREAD_HEAP_HEADER_SIZE) {
+        if (size > SIZE_MAX - MP_THREAD_HEAP_HEADER_SIZE) return NULL;
+        mp_HeapBlock *block = malloc(MP_THREAD_HEAP_HEADER_SIZE + size);
+        if (block == NULL) return NULL;
+        block->link.owner = NULL;
+        block->size_class = MP_THREAD_HEAP_CLASSES;
+        return (uint8_t *) block + MP_THREAD_HEAP_HEADER_SIZE;
+    }
+
+    size_t size_class = 0;
+    if (size + MP_THREAD_HEAP_HEADER_SIZE > 32)
+        size_class = mp_log2(size + MP_THREAD_HEAP_HEADER_SIZE - 1) - 4;
+    mp_ThreadCache *cache = mp_thread_cache_get(self);
+    if (cache == NULL) return NULL;
+
+    mp_HeapBlockList *list = &cache->free[size_class];
+    if (list->head == NULL) {
+        mp_thread_cache_collect(cache);
+        if (list->head == NULL && !mp_thread_cache_refill(cache, size_class)) return NULL;
+    }
+    mp_HeapBlock *block = list->head;
+    list->head          = block->link.next;
+    --list->len;
+    block->link.owner = cache;
+    return (uint8_t *) block + MP_THREAD_HEAP_HEADER_SIZE;
+}
+
+static void *mp_thread_heap_alloc(mp_ThreadHeap *self, size_t size) {
+    void *result = mp_thread_heap_take(self, size);
+    if (result == NULL) return NULL;
+    return memset(result, 0, size);
+}
+
+static void mp_thread_heap_free(mp_ThreadHeap *self, void *ptr) {
+    if (ptr == NULL) return;
+    mp_HeapBlock *block = (mp_HeapBlock *) ((uint8_t *) ptr - MP_THREAD_HEAP_HEADER_SIZE);
+    if (block->size_class == MP_THREAD_HEAP_CLASSES) {
+        free(block);
+        return;
+    }
+
+    mp_ThreadCache *owner = block->link.owner;
+    if (owner != pthread_getspecific(self->key)) {
+        // Hand the block back to the thread that allocated it
+        mp_HeapBlock *head = atomic_load_explicit(&owner->remote, memory_order_relaxed);
+        do {
+            block->link.next = head;
+        } while (!atomic_compare_exchange_weak_explicit(
+            &owner->remote, &head, block, memory_order_release, memory_order_relaxed));
+        return;
+    }
+
+    mp_HeapBlockList *list = &owner->free[block->size_class];
+    mp_heap_block_push(list, block);
+    if (list->len >= 2 * MP_THREAD_HEAP_BATCH) {
+        pthread_mutex_lock(&self->lock);
+        mp_heap_block_move(&self->free[block->size_class], list, MP_THREAD_HEAP_BATCH);
+        pthread_mutex_unlock(&self->lock);
+    }
+}
+
+static void *mp_thread_heap_realloc(mp_ThreadHeap *self, void *old_ptr, size_t old_size,
+                                    size_t new_size) {
+    if (old_ptr == NULL) return mp_thread_heap_alloc(self, new_size);
+    if (new_size <= old_size) return old_ptr;
+
+    mp_HeapBlock *block = (mp_HeapBlock *) ((uint8_t *) old_ptr - MP_THREAD_HEAP_HEADER_SIZE);
+    if (block->size_class == MP_THREAD_HEAP_CLASSES) {
+        if (new_size > SIZE_MAX - MP_THREAD_HEAP_HEADER_SIZE) return NULL;
+        block = realloc(block, MP_THREAD_HEAP_HEADER_SIZE + new_size);
+        if (block == NULL) return NULL;
+        return (uint8_t *) block + MP_THREAD_HEAP_HEADER_SIZE;
+    }
+    if (new_size + MP_THREAD_HEAP_HEADER_SIZE <= mp_thread_heap_block_size(block->size_class))
+        return old_ptr;
+
+    void *result = mp_thread_heap_take(self, new_size);
+    if (result == NULL) return NULL;
+    memcpy(result, old_ptr, old_size);
+    mp_thread_heap_free(self, old_ptr);
+    return result;
+}
+
+static void *mp_thread_heap_dup(mp_ThreadHeap *self, void *data, size_t size) {
+    void *result = mp_thread_heap_take(self, size);
+    if (result == NULL) return NULL;
+    return memcpy(result, data, size);
+}
+
+void mp_thread_heap_init(mp_ThreadHeap *self) {
+    memset(self, 0, sizeof(*self));
+    int result = pthread_key_create(&self->key, mp_thread_cache_release);
+    MEMPLUS_ASSERT(result == 0 && "failed to create thread key");
+    (void) result;
+    pthread_mutex_init(&self->lock, NULL);
+}
+
+void mp_thread_heap_destroy(mp_ThreadHeap *self) {
+    pthread_key_delete(self->key);
+    mp_ThreadCache *cache = self->caches;
+    while (cache != NULL) {
+        mp_ThreadCache *next = cache->next;
+        free(cache);
+        cache = next;
+    }
+    void *slab = self->slabs;
+    while (slab != NULL) {
+        void *next = *(void **) slab;
+        free(slab);
+        slab = next;
+    }
+    pthread_mutex_destroy(&self->lock);
+    self->caches = NULL;
+    self->idle   = NULL;
+    self->slabs  = NULL;
+    memset(self->free, 0, sizeof(self->free));
+}
+
+mp_Allocator mp_thread_heap_allocator(const mp_ThreadHeap *self) {
+    return mp_allocator_new(self,
+                            mp_thread_heap_alloc,
+                            mp_thread_heap_realloc,
+                            mp_thread_heap_dup,
+                            mp_thread_heap_free);
+}
+
+#undef MP_THREAD_HEAP_HEADER_SIZE
+#endif /* if defined(MEMPLUS_POSIX) && !defined(MEMPLUS_NO_THREADS) && C11 */
+
+static const char mp_digit_pairs[201] = "00010203040506070809"
+                                        "10111213141516171819"
+                                        "20212223242526272829"
+                                        "30313233343536373839"
+                                        "40414243444546474849"
+                                        "50515253545556575859"
+                                        "60616263646566676869"
+                                        "70717273747576777879"
+                                        "80818283848586878889"
+                                        "90919293949596979899";
+
+static size_t mp_count_digits(uint64_t value) {
+    size_t result = 1;
+    for (;;) {
+        if (value < 10) return result;
+        if (value < 100) return result + 1;
+        if (value < 1000) return result + 2;
+        if (value < 10000) return result + 3;
+        value /= 10000;
+        result += 4;
+    }
+}
+
+/* Writes exactly `len` digits of `value` ending at `buf + len`, two digits at a time. */
+static void mp_write_digits(char *buf, uint64_t value, size_t len) {
+    char *ptr = buf + len;
+    while (value >= 100) {
+        size_t pair = (value % 100) * 2;
+        value /= 100;
+        *--ptr = mp_digit_pairs[pair + 1];
+        *--ptr = mp_digit_pairs[pair];
+    }
+    if (value >= 10) {
+        *--ptr = mp_digit_pairs[value * 2 + 1];
+        *--ptr = mp_digit_pairs[value * 2];
+    } else {
+        *--ptr = '0' + value;
+    }
+}
+
+size_t mp_format_uint(char *buf, unsigned long long value) {
+    size_t len = mp_count_digits(value);
+    mp_write_digits(buf, value, len);
+    return len;
+}
+
+size_t mp_format_int(char *buf, long long value) {
+    if (value >= 0) return mp_format_uint(buf, value);
+    buf[0] = '-';
+    // Negating in unsigned arithmetic also works for LLONG_MIN
+    return mp_format_uint(buf + 1, -(unsigned long long) value) + 1;
+}
+
+// Tables for Ryu. The 128-bit values are stored as { low, high }.
+// Only every 26th power of 5 is stored, the rest are computed by multiplying with a 64-bit power of
+// 5 and adding the 2-bit corrections packed in the offset tables.
+#define MP_POW5_BITCOUNT     125
+#define MP_POW5_INV_BITCOUNT 125
+
+static const uint64_t mp_pow5_table[26] = {
+    UINT64_C(1),
+    UINT64_C(5),
+    UINT64_C(25),
+    UINT64_C(125),
+    UINT64_C(625),
+    UINT64_C(3125),
+    UINT64_C(15625),
+    UINT64_C(78125),
+    UINT64_C(390625),
+    UINT64_C(1953125),
+    UINT64_C(9765625),
+    UINT64_C(48828125),
+    UINT64_C(244140625),
+    UINT64_C(1220703125),
+    UINT64_C(6103515625),
+    UINT64_C(30517578125),
+    UINT64_C(152587890625),
+    UINT64_C(762939453125),
+    UINT64_C(3814697265625),
+    UINT64_C(19073486328125),
+    UINT64_C(95367431640625),
+    UINT64_C(476837158203125),
+    UINT64_C(2384185791015625),
+    UINT64_C(11920928955078125),
+    UINT64_C(59604644775390625),
+    UINT64_C(298023223876953125),
+};
+
+static const uint64_t mp_pow5_split[13][2] = {
+    { UINT64_C(0x0000000000000000), UINT64_C(0x1000000000000000) },
+    { UINT64_C(0x0000000000000000), UINT64_C(0x14adf4b7320334b9) },
+    { UINT64_C(0x0e549208b31adb10), UINT64_C(0x1aba4714957d300d) },
+    { UINT64_C(0x6dc6ad264d8f0866), UINT64_C(0x1145b7e285bf98f5) },
+    { UINT64_C(0xeb1dbd923d8596ca), UINT64_C(0x1652efdc6018a1fc) },
+    { UINT64_C(0xb4c1b80b22ae923c), UINT64_C(0x1cda62055b2d9d83) },
+    { UINT64_C(0x5bb28b4e8f7e4c30), UINT64_C(0x12a5568b9f52f416) },
+    { UINT64_C(0xf08aed437682d4fb), UINT64_C(0x1819651531f9e78f) },
+    { UINT64_C(0xb4ee134ad99bf150), UINT64_C(0x1f25c186a6f04c28) },
+    { UINT64_C(0x16499ecb70c25f03), UINT64_C(0x1420eb449c8842e6) },
+    { UINT64_C(0x85a56ead360865b0), UINT64_C(0x1a03fde214caf085) },
+    { UINT64_C(0x093db1d57999890b), UINT64_C(0x10cfeb353a97dad8) },
+    { UINT64_C(0xcf38bb735e3f36ac), UINT64_C(0x15baaf44fa52673e) },
+};
+
+static const uint64_t mp_pow5_inv_split[15][2] = {
+    { UINT64_C(0x0000000000000001), UINT64_C(0x2000000000000000) },
+    { UINT64_C(0x52a6c95fc0655034), UINT64_C(0x18c240c4aecb13bb) },
+    { UINT64_C(0x7ca8d50071dfc806), UINT64_C(0x1327fc58da0f6ff5) },
+    { UINT64_C(0x6520247d3556476e), UINT64_C(0x1da48ce468e7c702) },
+    { UINT64_C(0x6139cdd76802e6e9), UINT64_C(0x16ef5b40c2fc7779) },
+    { UINT64_C(0xf951a7ff43de8c79), UINT64_C(0x11bebdf578b2f391) },
+    { UINT64_C(0x7be8bee8d6e957e8), UINT64_C(0x1b758d848fac54b0) },
+    { UINT64_C(0x8bd3f9e999a423ea), UINT64_C(0x153eda614071a3b7) },
+    { UINT64_C(0x0848f973cb3ee3ce), UINT64_C(0x10701bd527b4978c) },
+    { UINT64_C(0x153285ebb9efbfa2), UINT64_C(0x196fbb9bb44db44d) },
+    { UINT64_C(0xadeee7f86c07b696), UINT64_C(0x13ae3591f5b4d936) },
+    { UINT64_C(0x4d686a4eaf182222), UINT64_C(0x1e74404f3daada91) },
+    { UINT64_C(0x98c0a106e09ebd9f), UINT64_C(0x17900ea4fda7c257) },
+    { UINT64_C(0x8f20e37371497d0e), UINT64_C(0x123b140576d820b2) },
+    { UINT64_C(0xb043138134743d85), UINT64_C(0x1c35f4275f7a29ad) },
+};
+
+static const uint32_t mp_pow5_offsets[21] = {
+    0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x40000000, 0x59695995, 0x55545555, 0x56555515,
+    0x41150504, 0x40555410, 0x44555145, 0x44504540, 0x45555550, 0x40004000, 0x96440440, 0x55565565,
+    0x54454045, 0x40154151, 0x55559155, 0x51405555, 0x00000105,
+};
+
+static const uint32_t mp_pow5_inv_offsets[22] = {
+    0x54544554, 0x04055545, 0x10041000, 0x00400414, 0x40010000, 0x41155555, 0x00000454, 0x00010044,
+    0x40000000, 0x44000041, 0x50454450, 0x55550054, 0x51655554, 0x40004000, 0x01000001, 0x00010500,
+    0x51515411, 0x05555554, 0x50411500, 0x40040000, 0x05040110, 0x00000000,
+};
+
+/* Shifts the 128-bit value `hi:lo` right by `dist`, which must be in (0, 64). */
+static inline uint64_t mp_shiftright128(uint64_t lo, uint64_t hi, size_t dist) {
+    MEMPLUS_ASSERT(dist > 0 && dist < 64);
+    return (hi << (64 - dist)) | (lo >> dist);
+}
+
+static inline size_t mp_pow5bits(int32_t e) {
+    return (size_t) (((uint32_t) e * 1217359) >> 19) + 1;
+}
+
+static inline int32_t mp_log10_pow2(int32_t e) {
+    return (int32_t) (((uint32_t) e * 78913) >> 18);
+}
+
+static inline int32_t mp_log10_pow5(int32_t e) {
+    return (int32_t) (((uint32_t) e * 732923) >> 20);
+}
+
+/* Computes `mul * m >> delta` of a 128-bit `mul` and stores the low 128 bits in `result`. */
+static void mp_mul_shift128(const uint64_t mul[2], uint64_t m, size_t delta, uint64_t result[2]) {
+    uint64_t b0_hi, b2_hi;
+    uint64_t b0_lo = mp_umul128(m, mul[0], &b0_hi);
+    uint64_t b2_lo = mp_umul128(m, mul[1], &b2_hi);
+    uint64_t mid   = b0_hi + b2_lo;
+    b2_hi += mid < b0_hi;
+    result[0] = mp_shiftright128(b0_lo, mid, delta);
+    result[1] = mp_shiftright128(mid, b2_hi, delta);
+}
+
+/* Returns 5^i scaled to `MP_POW5_BITCOUNT` bits. */
+static void mp_compute_pow5(uint32_t i, uint64_t result[2]) {
+    uint32_t base   = i / 26;
+    uint32_t offset = i - base * 26;
+    if (offset == 0) {
+        result[0] = mp_pow5_split[base][0];
+        result[1] = mp_pow5_split[base][1];
+        return;
+    }
+    size_t delta = mp_pow5bits(i) - mp_pow5bits(base * 26);
+    mp_mul_shift128(mp_pow5_split[base], mp_pow5_table[offset], delta, result);
+    uint64_t correction = (mp_pow5_offsets[i / 16] >> ((i % 16) << 1)) & 3;
+    result[0] += correction;
+    result[1] += result[0] < correction;
+}
+
+/* Returns 1/5^i scaled to `MP_POW5_INV_BITCOUNT` bits, rounded up. */
+static void mp_compute_inv_pow5(uint32_t i, uint64_t result[2]) {
+    uint32_t base   = (i + 25) / 26;
+    uint32_t offset = base * 26 - i;
+    if (offset == 0) {
+        result[0] = mp_pow5_inv_split[base][0];
+        result[1] = mp_pow5_inv_split[base][1];
+        return;
+    }
+    const uint64_t *split = mp_pow5_inv_split[base];
+    uint64_t        mul[2] = { split[0] - 1, split[1] - (split[0] == 0) };
+    size_t          delta  = mp_pow5bits(base * 26) - mp_pow5bits(i);
+    mp_mul_shift128(mul, mp_pow5_table[offset], delta, result);
+    uint64_t correction = 1 + ((mp_pow5_inv_offsets[i / 16] >> ((i % 16) << 1)) & 3);
+    result[0] += correction;
+    result[1] += result[0] < correction;
+}
+
+/* Returns `m * mul >> j` where `j` is at least 64. */
+static inline uint64_t mp_mul_shift64(uint64_t m, const uint64_t mul[2], int32_t j) {
+    uint64_t high1, high0;
+    uint64_t low1 = mp_umul128(m, mul[1], &high1);
+    mp_umul128(m, mul[0], &high0);
+    uint64_t sum = high0 + low1;
+    high1 += sum < high0;
+    return mp_shiftright128(sum, high1, j - 64);
+}
+
+static inline uint32_t mp_pow5_factor(uint64_t value) {
+    uint32_t result = 0;
+    while (value % 5 == 0) {
+        value /= 5;
+        ++result;
+    }
+    return result;
+}
+
+/* Computes the shortest `digits` * 10^`exponent` that rounds to the finite nonzero double whose
+ * mantissa and exponent bits are `ieee_mantissa` and `ieee_exponent`. */
+static void mp_ryu(uint64_t ieee_mantissa, uint32_t ieee_exponent, uint64_t *digits,
+                   int32_t *exponent) {
+    int32_t  e2;
+    uint64_t m2;
+    if (ieee_exponent == 0) {
+        e2 = 1 - 1023 - 52 - 2;
+        m2 = ieee_mantissa;
+    } else {
+        e2 = (int32_t) ieee_exponent - 1023 - 52 - 2;
+        m2 = (UINT64_C(1) << 52) | ieee_mantissa;
+    }
+    bool accept_bounds = (m2 & 1) == 0;
+
+    // Step 2: Determine the interval of valid decimal representations
+    uint64_t mv       = 4 * m2;
+    uint32_t mm_shift = ieee_mantissa != 0 || ieee_exponent <= 1;
+
+    // Step 3: Convert to a decimal power base
+    uint64_t vr, vp, vm;
+    int32_t  e10;
+    bool     vm_trailing_zeros = false, vr_trailing_zeros = false;
+    uint64_t pow5[2];
+    if (e2 >= 0) {
+        int32_t q = mp_log10_pow2(e2) - (e2 > 3);
+        e10       = q;
+        int32_t k = MP_POW5_INV_BITCOUNT + (int32_t) mp_pow5bits(q) - 1;
+        int32_t i = -e2 + q + k;
+        mp_compute_inv_pow5(q, pow5);
+        vr = mp_mul_shift64(4 * m2, pow5, i);
+        vp = mp_mul_shift64(4 * m2 + 2, pow5, i);
+        vm = mp_mul_shift64(4 * m2 - 1 - mm_shift, pow5, i);
+        if (q <= 21) {
+            // Only one of mp, mv and mm can be a multiple of 5, if any
+            if (mv % 5 == 0) {
+                vr_trailing_zeros = mp_pow5_factor(mv) >= (uint32_t) q;
+            } else if (accept_bounds) {
+                vm_trailing_zeros = mp_pow5_factor(mv - 1 - mm_shift) >= (uint32_t) q;
+            } else {
+                vp -= mp_pow5_factor(mv + 2) >= (uint32_t) q;
+            }
+        }
+    } else {
+        int32_t q = mp_log10_pow5(-e2) - (-e2 > 1);
+        e10       = q + e2;
+        int32_t i = -e2 - q;
+        int32_t k = (int32_t) mp_pow5bits(i) - MP_POW5_BITCOUNT;
+        int32_t j = q - k;
+        mp_compute_pow5(i, pow5);
+        vr = mp_mul_shift64(4 * m2, pow5, j);
+        vp = mp_mul_shift64(4 * m2 + 2, pow5, j);
+        vm = mp_mul_shift64(4 * m2 - 1 - mm_shift, pow5, j);
+        if (q <= 1) {
+            // mv has at least q trailing 0 bits, so vr has at least q trailing decimal zeros
+            vr_trailing_zeros = true;
+            if (accept_bounds) {
+                vm_trailing_zeros = mm_shift == 1;
+            } else {
+                --vp;
+            }
+        } else if (q < 63) {
+            vr_trailing_zeros = (mv & ((UINT64_C(1) << q) - 1)) == 0;
+        }
+    }
+
+    // Step 4: Find the shortest decimal representation in the interval
+    int32_t removed = 0;
+    uint8_t last_removed_digit = 0;
+    uint64_t output;
+    if (vm_trailing_zeros || vr_trailing_zeros) {
+        while (vp / 10 > vm / 10) {
+            vm_trailing_zeros &= vm % 10 == 0;
+            vr_trailing_zeros &= last_removed_digit == 0;
+            last_removed_digit = vr % 10;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            ++removed;
+        }
+        if (vm_trailing_zeros) {
+            while (vm % 10 == 0) {
+                vr_trailing_zeros &= last_removed_digit == 0;
+                last_removed_digit = vr % 10;
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                ++removed;
+            }
+        }
+        // Round to even if the exact value is halfway between two representations
+        if (vr_trailing_zeros && last_removed_digit == 5 && vr % 2 == 0) last_removed_digit = 4;
+        output = vr + ((vr == vm && (!accept_bounds || !vm_trailing_zeros)) ||
+                       last_removed_digit >= 5);
+    } else {
+        // Common case where none of the bounds are exact
+        bool round_up = false;
+        while (vp / 100 > vm / 100) {
+            round_up = vr % 100 >= 50;
+            vr /= 100;
+            vp /= 100;
+            vm /= 100;
+            removed += 2;
+        }
+        while (vp / 10 > vm / 10) {
+            round_up = vr % 10 >= 5;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            ++removed;
+        }
+        output = vr + (vr == vm || round_up);
+    }
+    *digits   = output;
+    *exponent = e10 + removed;
+}
+
+size_t mp_format_double(char *buf, double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    bool     sign          = bits >> 63;
+    uint64_t ieee_mantissa = bits & ((UINT64_C(1) << 52) - 1);
+    uint32_t ieee_exponent = (uint32_t) (bits >> 52) & 0x7ff;
+
+    char *ptr = buf;
+    if (ieee_exponent == 0x7ff && ieee_mantissa != 0) {
+        memcpy(ptr, "nan", 3);
+        return 3;
+    }
+    if (sign) *ptr++ = '-';
+    if (ieee_exponent == 0x7ff) {
+        memcpy(ptr, "inf", 3);
+        return ptr - buf + 3;
+    }
+    if (ieee_exponent == 0 && ieee_mantissa == 0) {
+        *ptr = '0';
+        return ptr - buf + 1;
+    }
+
+    uint64_t digits;
+    int32_t  exponent;
+    mp_ryu(ieee_mantissa, ieee_exponent, &digits, &exponent);
+    int32_t len        = (int32_t) mp_count_digits(digits);
+    int32_t scientific = exponent + len - 1;    // Exponent in scientific notation
+
+    if (scientific < -4 || scientific >= 17) {
+        // d[.ddd]e±XX
+        mp_write_digits(ptr + 1, digits, len);
+        ptr[0] = ptr[1];
+        if (len > 1) {
+            ptr[1] = '.';
+            ptr += len + 1;
+        } else {
+            ptr += 1;
+        }
+        *ptr++ = 'e';
+        *ptr++ = scientific < 0 ? '-' : '+';
+        uint32_t abs_exponent = scientific < 0 ? -scientific : scientific;
+        size_t   exponent_len = mp_count_digits(abs_exponent);
+        if (abs_exponent < 10) *ptr++ = '0';    // At least two digits like printf
+        mp_write_digits(ptr, abs_exponent, exponent_len);
+        return ptr - buf + exponent_len;
+    }
+
+    if (exponent >= 0) {
+        // Integer: digits followed by zeros
+        mp_write_digits(ptr, digits, len);
+        memset(ptr + len, '0', exponent);
+        return ptr - buf + len + exponent;
+    }
+    if (scientific >= 0) {
+        // Point inside the digits
+        int32_t int_len = scientific + 1;
+        mp_write_digits(ptr + 1, digits, len);
+        memmove(ptr, ptr + 1, int_len);
+        ptr[int_len] = '.';
+        return ptr - buf + len + 1;
+    }
+    // 0.000ddd
+    int32_t zeros = -scientific - 1;
+    ptr[0]        = '0';
+    ptr[1]        = '.';
+    memset(ptr + 2, '0', zeros);
+    mp_write_digits(ptr + 2 + zeros, digits, len);
+    return ptr - buf + 2 + zeros + len;
+}
+
+#undef MP_POW5_BITCOUNT
+#undef MP_POW5_INV_BITCOUNT
+
+/* Formats `fmt` into `buf` without `vsnprintf`. Only handles the conversions listed at
+ * `mp_string_newf`. Returns the length of the null-terminated result, or -1 if `fmt` needs
+ * `vsnprintf` or the result does not fit in `cap` characters. */
+static int mp_format_fast(char *buf, size_t cap, const char *fmt, va_list args) {
+    if (cap == 0) return -1;
+    char *ptr = buf;
+    char *end = buf + cap - 1;    // Keeps room for the null-terminator
+    char  tmp[MP_FORMAT_INT_SIZE];
+
+    while (*fmt != '\0') {
+        const char *text;
+        size_t      len;
+        if (*fmt != '%') {
+            const char *next = strchr(fmt, '%');
+            len              = next ? (size_t) (next - fmt) : strlen(fmt);
+            if ((size_t) (end - ptr) < len) return -1;
+            memcpy(ptr, fmt, len);
+            ptr += len;
+            fmt += len;
+            continue;
+        }
+        ++fmt;
+
+        int precision = -1;
+        if (*fmt == '.') {
+            ++fmt;
+            if (*fmt == '*') {
+                precision = va_arg(args, int);
+                ++fmt;
+            } else {
+                precision = 0;
+                while (*fmt >= '0' && *fmt <= '9')
+                    precision = precision * 10 + (*fmt++ - '0');
+            }
+        }
+
+        // 0: int, 1: long, 2: long long, 3: size_t
+        int length = 0;
+        if (*fmt == 'l') {
+            length = 1;
+            if (*++fmt == 'l') {
+                length = 2;
+                ++fmt;
+            }
+        } else if (*fmt == 'z') {
+            length = 3;
+            ++fmt;
+        }
+
+        char conversion = *fmt++;
+        if (precision >= 0 && conversion != 's') return -1;
+        switch (conversion) {
+            case '%': {
+                if (length != 0) return -1;
+                text = "%";
+                len  = 1;
+            } break;
+            case 'c': {
+                if (length != 0) return -1;
+                tmp[0] = (char) va_arg(args, int);
+                text   = tmp;
+                len    = 1;
+            } break;
+            case 's': {
+                if (length != 0) return -1;
+                text = va_arg(args, const char *);
+                if (text == NULL) return -1;
+                if (precision >= 0) {
+                    const char *nul = memchr(text, '\0', precision);
+                    len             = nul ? (size_t) (nul - text) : (size_t) precision;
+                } else {
+                    len = strlen(text);
+                }
+            } break;
+            case 'd':
+            case 'i': {
+                long long value;
+                switch (length) {
+                    case 0: value = va_arg(args, int); break;
+                    case 1: value = va_arg(args, long); break;
+                    case 2: value = va_arg(args, long long); break;
+                    default: {
+                        // %zd takes the signed type of the same width as size_t, which C has no
+                        // name for. It is read as size_t and converted back without overflowing.
+                        size_t raw = va_arg(args, size_t);
+                        value      = raw > SIZE_MAX / 2 ? -(long long) (SIZE_MAX - raw) - 1
+                                                        : (long long) raw;
+                    } break;
+                }
+                text = tmp;
+                len  = mp_format_int(tmp, value);
+            } break;
+            case 'u':
+            case 'x': {
+                unsigned long long value;
+                switch (length) {
+                    case 0:  value = va_arg(args, unsigned int); break;
+                    case 1:  value = va_arg(args, unsigned long); break;
+                    case 2:  value = va_arg(args, unsigned long long); break;
+                    default: value = va_arg(args, size_t); break;
+                }
+                text = tmp;
+                if (conversion == 'u') {
+                    len = mp_format_uint(tmp, value);
+                } else {
+                    char *digit = tmp + sizeof(tmp);
+                    do {
+                        *--digit = "0123456789abcdef"[value & 15];
+                        value >>= 4;
+                    } while (value != 0);
+                    text = digit;
+                    len  = tmp + sizeof(tmp) - digit;
+                }
+            } break;
+            default: return -1;
+        }
+
+        if ((size_t) (end - ptr) < len) return -1;
+        memcpy(ptr, text, len);
+        ptr += len;
+    }
+
+    *ptr = '\0';
+    return ptr - buf;
+}
+
+mp_String mp_string_new(const mp_Allocator *allocator, const char *str) {
+    size_t len    = strlen(str);
+    char  *result = mp_alloc(allocator, len + 1);
+    if (result == NULL) return (mp_String){ 0, NULL };
+    memcpy(result, str, len + 1);
+    return (mp_String){ len, result };
+}
+
+mp_String mp_string_newf(const mp_Allocator *allocator, const char *fmt, ...) {
+    va_list args;
+    char   *result;
+
+    char buf[MP_STRING_FORMAT_BUFFER_SIZE];
+    va_start(args, fmt);
+    int fast_len = mp_format_fast(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    if (fast_len >= 0) {
+        result = mp_dup(allocator, buf, fast_len + 1);
+        if (result == NULL) return (mp_String){ 0, NULL };
+        return (mp_String){ fast_len, result };
+    }
+
+    va_start(args, fmt);
+    int len = vsnprintf(NULL, 0, fmt, args);
+    MEMPLUS_ASSERT(len >= 0 && "failed to count string length");
+    va_end(args);
+
+    result = mp_alloc(allocator, len + 1);
+    if (result == NULL) return (mp_String){ 0, NULL };
+
+    va_start(args, fmt);
+    int result_len = vsnprintf(result, len + 1, fmt, args);
+    MEMPLUS_ASSERT(result_len == len);
+    va_end(args);
+
+    return (mp_String){ result_len, result };
+}
+
+mp_String mp_string_dup(const mp_Allocator *allocator, mp_String str) {
+    // Includes the null-terminator
+    char *ptr = mp_dup(allocator, str.cstr, str.len + 1);
+    if (ptr == NULL) return (mp_String){ 0, NULL };
+    return (mp_String){ str.len, ptr };
+}
+
+void mp_string_destroy(const mp_Allocator *allocator, mp_String *str) {
+    mp_free(allocator, str->cstr);
+    str->len = 0;
+}
+
+void mp_string_builder_init(mp_StringBuilder *self, mp_Allocator *allocator) {
+    mp_vector_init(self, allocator);
+}
+
+void mp_string_builder_destroy(mp_StringBuilder *self) {
+    mp_vector_destroy(self);
+}
+
+void mp_string_builder_clear(mp_StringBuilder *self) {
+    self->len = 0;
+    if (self->data != NULL) self->data[0] = '\0';
+}
+
+bool mp_string_builder_reserve(mp_StringBuilder *self, size_t amount) {
+    if (self->len + amount < self->cap) return true;
+    size_t new_cap = self->cap == 0 ? MP_VECTOR_INIT_CAPACITY : self->cap;
+    while (self->len + amount >= new_cap)
+        new_cap *= 2;
+    char *data = mp_realloc(self->alloc, self->data, self->cap, new_cap);
+    if (data == NULL) return false;
+    if (self->data == NULL) data[0] = '\0';
+    self->data = data;
+    self->cap  = new_cap;
+    return true;
+}
+
+bool mp_string_builder_append(mp_StringBuilder *self, const char *str, size_t len) {
+    if (!mp_string_builder_reserve(self, len)) return false;
+    memcpy(self->data + self->len, str, len);
+    self->len += len;
+    self->data[self->len] = '\0';
+    return true;
+}
+
+bool mp_string_builder_append_cstr(mp_StringBuilder *self, const char *cstr) {
+    return mp_string_builder_append(self, cstr, strlen(cstr));
+}
+
+bool mp_string_builder_append_string(mp_StringBuilder *self, mp_String str) {
+    return mp_string_builder_append(self, str.cstr, str.len);
+}
+
+bool mp_string_builder_append_char(mp_StringBuilder *self, char c) {
+    if (!mp_string_builder_reserve(self, 1)) return false;
+    self->data[self->len++] = c;
+    self->data[self->len]   = '\0';
+    return true;
+}
+
+bool mp_string_builder_append_uint(mp_StringBuilder *self, unsigned long long value) {
+    if (!mp_string_builder_reserve(self, MP_FORMAT_INT_SIZE)) return false;
+    self->len += mp_format_uint(self->data + self->len, value);
+    self->data[self->len] = '\0';
+    return true;
+}
+
+bool mp_string_builder_append_int(mp_StringBuilder *self, long long value) {
+    if (!mp_string_builder_reserve(self, MP_FORMAT_INT_SIZE)) return false;
+    self->len += mp_format_int(self->data + self->len, value);
+    self->data[self->len] = '\0';
+    return true;
+}
+
+bool mp_string_builder_append_double(mp_StringBuilder *self, double value) {
+    if (!mp_string_builder_reserve(self, MP_FORMAT_DOUBLE_SIZE)) return false;
+    self->len += mp_format_double(self->data + self->len, value);
+    self->data[self->len] = '\0';
+    return true;
+}
+
+bool mp_string_builder_appendf(mp_StringBuilder *self, const char *fmt, ...) {
+    va_list args, args_copy;
+    if (!mp_string_builder_reserve(self, 0)) return false;
+    size_t room = self->cap - self->len;
+
+    va_start(args, fmt);
+    int fast_len = mp_format_fast(self->data + self->len, room, fmt, args);
+    va_end(args);
+    if (fast_len >= 0) {
+        self->len += fast_len;
+        return true;
+    }
+
+    va_start(args, fmt);
+    va_copy(args_copy, args);
+    int len = vsnprintf(self->data + self->len, room, fmt, args);
+    va_end(args);
+    MEMPLUS_ASSERT(len >= 0 && "failed to format string");
+
+    bool result = true;
+    if ((size_t) len >= room) {
+        if (!mp_string_builder_reserve(self, len)) {
+            self->data[self->len] = '\0';
+            return_defer(false);
+        }
+        vsnprintf(self->data + self->len, len + 1, fmt, args_copy);
+    }
+    self->len += len;
+
+defer:
+    va_end(args_copy);
+    return result;
+}
+
+mp_String mp_string_builder_to_string(mp_StringBuilder *self) {
+    if (!mp_string_builder_reserve(self, 0)) return (mp_String){ 0, NULL };
+    mp_String result = { self->len, self->data };
+    self->len        = 0;
+    self->cap        = 0;
+    self->data       = NULL;
+    return result;
+}
+
+mp_Slice mp_slice_from_cstr(const char *cstr) {
+    return (mp_Slice){ strlen(cstr), cstr };
+}
+
+mp_Slice mp_slice_from_string(mp_String str) {
+    return (mp_Slice){ str.len, str.cstr };
+}
+
+mp_String mp_string_from_slice(const mp_Allocator *allocator, mp_Slice slice) {
+    char *result = mp_alloc(allocator, slice.len + 1);
+    if (result == NULL) return (mp_String){ 0, NULL };
+    if (slice.len > 0) memcpy(result, slice.ptr, slice.len);
+    result[slice.len] = '\0';
+    return (mp_String){ slice.len, result };
+}
+
+mp_Slice mp_slice_sub(mp_Slice self, size_t begin, size_t end) {
+    if (end > self.len) end = self.len;
+    if (begin > end) begin = end;
+    return (mp_Slice){ end - begin, self.ptr + begin };
+}
+
+static bool mp_is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+mp_Slice mp_slice_trim_left(mp_Slice self) {
+    size_t i = 0;
+    while (i < self.len && mp_is_space(self.ptr[i]))
+        ++i;
+    return (mp_Slice){ self.len - i, self.ptr + i };
+}
+
+mp_Slice mp_slice_trim_right(mp_Slice self) {
+    while (self.len > 0 && mp_is_space(self.ptr[self.len - 1]))
+        --self.len;
+    return self;
+}
+
+mp_Slice mp_slice_trim(mp_Slice self) {
+    return mp_slice_trim_right(mp_slice_trim_left(self));
+}
+
+bool mp_slice_split_next(mp_Slice *rest, char delim, mp_Slice *field) {
+    // `rest.ptr` is set to NULL once the last field is taken
+    if (rest->ptr == NULL) return false;
+    const char *found = rest->len > 0 ? memchr(rest->ptr, delim, rest->len) : NULL;
+    if (found == NULL) {
+        *field = *rest;
+        *rest  = (mp_Slice){ 0, NULL };
+        return true;
+    }
+    *field = (mp_Slice){ found - rest->ptr, rest->ptr };
+    *rest  = (mp_Slice){ rest->len - field->len - 1, found + 1 };
+    return true;
+}
+
+bool mp_slice_tokenize_next(mp_Slice *rest, const char *delims, mp_Slice *token) {
+    uint64_t table[4] = { 0 };
+    for (const unsigned char *c = (const unsigned char *) delims; *c != '\0'; ++c)
+        table[*c >> 6] |= (uint64_t) 1 << (*c & 63);
+#define MP_IS_DELIM(c) ((table[(unsigned char) (c) >> 6] >> ((unsigned char) (c) & 63)) & 1)
+
+    size_t begin = 0;
+    while (begin < rest->len && MP_IS_DELIM(rest->ptr[begin]))
+        ++begin;
+    if (begin == rest->len) {
+        *rest = (mp_Slice){ 0, rest->ptr + begin };
+        return false;
+    }
+    size_t end = begin + 1;
+    while (end < rest->len && !MP_IS_DELIM(rest->ptr[end]))
+        ++end;
+#undef MP_IS_DELIM
+
+    *token = (mp_Slice){ end - begin, rest->ptr + begin };
+    *rest  = (mp_Slice){ rest->len - end, rest->ptr + end };
+    return true;
+}
+
+bool mp_string_eq(mp_String a, mp_String b) {
+    return a.len == b.len && (a.len == 0 || memcmp(a.cstr, b.cstr, a.len) == 0);
+}
+
+bool mp_slice_eq(mp_Slice a, mp_Slice b) {
+    return a.len == b.len && (a.len == 0 || memcmp(a.ptr, b.ptr, a.len) == 0);
+}
 
-static void *mp_sarena_dup(mp_SArena *self, void *data, size_t size) {
-    void *buf = mp_sarena_alloc(self, size);
-    if (buf == NULL) return NULL;
-    return memcpy(buf, data, size);
+int mp_string_cmp(mp_String a, mp_String b) {
+    return mp_slice_cmp(mp_slice_from_string(a), mp_slice_from_string(b));
 }
 
-static void mp_sarena_free(mp_SArena *self, void *ptr) {
-    (void) self, (void) ptr;
+int mp_slice_cmp(mp_Slice a, mp_Slice b) {
+    size_t len    = a.len < b.len ? a.len : b.len;
+    int    result = len > 0 ? memcmp(a.ptr, b.ptr, len) : 0;
+    if (result != 0) return result;
+    return (a.len > b.len) - (a.len < b.len);
 }
 
-void mp_temp_init_size(mp_Temp *self, void *buffer, size_t cap) {
-    memset(buffer, 0, cap);
-    self->buf = buffer;
-    self->len = 0;
-    self->cap = cap / sizeof(uintptr_t);
+/* Search kernels of `mp_slice_find`. Candidates are positions where both the first and the last
+ * byte of the needle match, which rules out most positions before comparing the rest. They check
+ * positions from `*i` to `end` a block at a time and return the first match or `MP_NPOS`. `*i` is
+ * left at the first position that was not checked. */
+#if defined(__AVX2__) || defined(MP_AVX2_DISPATCH)
+MP_TARGET_AVX2 static size_t
+mp_slice_find_avx2(const char *h, size_t end, const char *n, size_t last, size_t *i) {
+    __m256i first_byte = _mm256_set1_epi8(n[0]);
+    __m256i last_byte  = _mm256_set1_epi8(n[last]);
+    for (; *i + 64 <= end; *i += 64) {
+        const char *block  = h + *i;
+        __m256i     match0 = _mm256_and_si256(
+            _mm256_cmpeq_epi8(first_byte, _mm256_loadu_si256((const __m256i *) block)),
+            _mm256_cmpeq_epi8(last_byte, _mm256_loadu_si256((const __m256i *) (block + last))));
+        __m256i match1 = _mm256_and_si256(
+            _mm256_cmpeq_epi8(first_byte, _mm256_loadu_si256((const __m256i *) (block + 32))),
+            _mm256_cmpeq_epi8(last_byte,
+                              _mm256_loadu_si256((const __m256i *) (block + 32 + last))));
+        __m256i any = _mm256_or_si256(match0, match1);
+        if (_mm256_testz_si256(any, any)) continue;
+        uint64_t mask = (uint32_t) _mm256_movemask_epi8(match0) |
+                        (uint64_t) (uint32_t) _mm256_movemask_epi8(match1) << 32;
+        while (mask != 0) {
+            size_t pos = *i + mp_ctz64(mask);
+            if (memcmp(h + pos + 1, n + 1, last - 1) == 0) return pos;
+            mask &= mask - 1;
+        }
+    }
+    return MP_NPOS;
 }
+#endif
 
-void mp_temp_reset(mp_Temp *self) {
-    memset(self->buf, 0, self->cap);
-    self->len = 0;
+#if defined(__SSE2__) && !defined(__AVX2__)
+static size_t mp_slice_find_sse2(const char *h, size_t end, const char *n, size_t last, size_t *i) {
+    __m128i first_byte = _mm_set1_epi8(n[0]);
+    __m128i last_byte  = _mm_set1_epi8(n[last]);
+    for (; *i + 32 <= end; *i += 32) {
+        const char *block  = h + *i;
+        __m128i     match0 = _mm_and_si128(
+            _mm_cmpeq_epi8(first_byte, _mm_loadu_si128((const __m128i *) block)),
+            _mm_cmpeq_epi8(last_byte, _mm_loadu_si128((const __m128i *) (block + last))));
+        __m128i match1 = _mm_and_si128(
+            _mm_cmpeq_epi8(first_byte, _mm_loadu_si128((const __m128i *) (block + 16))),
+            _mm_cmpeq_epi8(last_byte, _mm_loadu_si128((const __m128i *) (block + 16 + last))));
+        uint32_t mask = (uint32_t) _mm_movemask_epi8(match0) |
+                        (uint32_t) _mm_movemask_epi8(match1) << 16;
+        while (mask != 0) {
+            size_t pos = *i + mp_ctz64(mask);
+            if (memcmp(h + pos + 1, n + 1, last - 1) == 0) return pos;
+            mask &= mask - 1;
+        }
+    }
+    return MP_NPOS;
 }
+#endif
 
-mp_Allocator mp_temp_allocator(const mp_Temp *self) {
-    return mp_allocator_new(
-        self, mp_sarena_alloc, mp_sarena_realloc, mp_sarena_dup, mp_sarena_free);
+size_t mp_slice_find(mp_Slice self, mp_Slice needle) {
+    if (needle.len == 0) return 0;
+    if (needle.len > self.len) return MP_NPOS;
+    const char *h = self.ptr;
+    const char *n = needle.ptr;
+    if (needle.len == 1) {
+        const char *found = memchr(h, n[0], self.len);
+        return found ? (size_t) (found - h) : MP_NPOS;
+    }
+
+    size_t last  = needle.len - 1;
+    size_t end   = self.len - last;    // One past the last possible position
+    size_t i     = 0;
+#if defined(__AVX2__)
+    size_t pos   = mp_slice_find_avx2(h, end, n, last, &i);
+#elif defined(MP_AVX2_DISPATCH)
+    size_t pos   = __builtin_cpu_supports("avx2") ? mp_slice_find_avx2(h, end, n, last, &i)
+                                                  : mp_slice_find_sse2(h, end, n, last, &i);
+#elif defined(__SSE2__)
+    size_t pos   = mp_slice_find_sse2(h, end, n, last, &i);
+#else
+    size_t pos   = MP_NPOS;
+#endif
+    if (pos != MP_NPOS) return pos;
+
+    // The rest is checked a position at a time
+    while (i < end) {
+        const char *found = memchr(h + i, n[0], end - i);
+        if (found == NULL) return MP_NPOS;
+        i = found - h;
+        if (h[i + last] == n[last] && memcmp(h + i + 1, n + 1, last - 1) == 0) return i;
+        ++i;
+    }
+    return MP_NPOS;
 }
 
-mp_Allocator mp_heap_allocator(void) {
-    return mp_allocator_new(NULL, mp_heap_alloc, mp_heap_realloc, mp_heap_dup, mp_heap_free);
+/* Kernels of `mp_slice_find_any` for sets of up to 4 characters, same contract as the kernels of
+ * `mp_slice_find`. */
+#if defined(__AVX2__) || defined(MP_AVX2_DISPATCH)
+MP_TARGET_AVX2 static size_t
+mp_slice_find_any_avx2(mp_Slice self, const char *chars, size_t chars_len, size_t *i) {
+    __m256i set[4];
+    for (size_t c = 0; c < 4; ++c)
+        set[c] = _mm256_set1_epi8(chars[c < chars_len ? c : 0]);
+    for (; *i + 32 <= self.len; *i += 32) {
+        __m256i block = _mm256_loadu_si256((const __m256i *) (self.ptr + *i));
+        __m256i found = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(block, set[0]), _mm256_cmpeq_epi8(block, set[1])),
+            _mm256_or_si256(_mm256_cmpeq_epi8(block, set[2]), _mm256_cmpeq_epi8(block, set[3])));
+        uint32_t mask = (uint32_t) _mm256_movemask_epi8(found);
+        if (mask != 0) return *i + mp_ctz64(mask);
+    }
+    return MP_NPOS;
 }
+#endif
 
-static void *mp_heap_alloc(void *self, size_t size) {
-    (void) self;
-    return calloc(size, 1);
+#if defined(__SSE2__) && !defined(__AVX2__)
+static size_t
+mp_slice_find_any_sse2(mp_Slice self, const char *chars, size_t chars_len, size_t *i) {
+    __m128i set[4];
+    for (size_t c = 0; c < 4; ++c)
+        set[c] = _mm_set1_epi8(chars[c < chars_len ? c : 0]);
+    for (; *i + 16 <= self.len; *i += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i *) (self.ptr + *i));
+        __m128i found = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(block, set[0]), _mm_cmpeq_epi8(block, set[1])),
+            _mm_or_si128(_mm_cmpeq_epi8(block, set[2]), _mm_cmpeq_epi8(block, set[3])));
+        uint32_t mask = _mm_movemask_epi8(found);
+        if (mask != 0) return *i + mp_ctz64(mask);
+    }
+    return MP_NPOS;
 }
+#endif
 
-static void *mp_heap_realloc(void *self, void *old_ptr, size_t old_size, size_t new_size) {
-    (void) self;
-    if (new_size <= old_size) return old_ptr;
-    return realloc(old_ptr, new_size);
+size_t mp_slice_find_any(mp_Slice self, const char *chars) {
+    size_t chars_len = strlen(chars);
+    if (chars_len == 0) return MP_NPOS;
+    if (chars_len == 1) {
+        const char *found = self.len > 0 ? memchr(self.ptr, chars[0], self.len) : NULL;
+        return found ? (size_t) (found - self.ptr) : MP_NPOS;
+    }
+
+    size_t i = 0;
+    // Small sets are compared against every character at once
+#if defined(__AVX2__)
+    if (chars_len <= 4) {
+        size_t pos = mp_slice_find_any_avx2(self, chars, chars_len, &i);
+        if (pos != MP_NPOS) return pos;
+    }
+#elif defined(MP_AVX2_DISPATCH)
+    if (chars_len <= 4) {
+        size_t pos = __builtin_cpu_supports("avx2")
+                         ? mp_slice_find_any_avx2(self, chars, chars_len, &i)
+                         : mp_slice_find_any_sse2(self, chars, chars_len, &i);
+        if (pos != MP_NPOS) return pos;
+    }
+#elif defined(__SSE2__)
+    if (chars_len <= 4) {
+        size_t pos = mp_slice_find_any_sse2(self, chars, chars_len, &i);
+        if (pos != MP_NPOS) return pos;
+    }
+#endif
+
+    uint64_t table[4] = { 0 };
+    for (const unsigned char *c = (const unsigned char *) chars; *c != '\0'; ++c)
+        table[*c >> 6] |= (uint64_t) 1 << (*c & 63);
+    for (; i < self.len; ++i) {
+        unsigned char c = self.ptr[i];
+        if ((table[c >> 6] >> (c & 63)) & 1) return i;
+    }
+    return MP_NPOS;
 }
 
-static void *mp_heap_dup(void *self, void *data, size_t size) {
-    (void) self;
-    void *buf = mp_heap_alloc(self, size);
-    if (buf == NULL) return NULL;
-    return memcpy(buf, data, size);
+/* Multiplies `a` and `b` into 128 bits and folds the halves together. */
+static uint64_t mp_hash_mix(uint64_t a, uint64_t b) {
+    uint64_t hi;
+    uint64_t lo = mp_umul128(a, b, &hi);
+    return lo ^ hi;
 }
 
-static void mp_heap_free(void *self, void *ptr) {
-    (void) self;
-    free(ptr);
+static uint64_t mp_read64(const uint8_t *p) {
+    uint64_t result;
+    memcpy(&result, p, sizeof(result));
+    return result;
 }
 
-mp_String mp_string_new(const mp_Allocator *allocator, const char *str) {
-    int size = snprintf(NULL, 0, "%s", str);
-    MEMPLUS_ASSERT(size >= 0 && "failed to count string size");
-    char *result = mp_alloc(allocator, size + 1);
-    if (result == NULL) return (mp_String){ 0, NULL };
-    int result_size = snprintf(result, size + 1, "%s", str);
-    MEMPLUS_ASSERT(result_size == size);
-    return (mp_String){ result_size, result };
+static uint64_t mp_read32(const uint8_t *p) {
+    uint32_t result;
+    memcpy(&result, p, sizeof(result));
+    return result;
 }
 
-mp_String mp_string_newf(const mp_Allocator *allocator, const char *fmt, ...) {
-    va_list args;
+uint64_t mp_hash(const void *data, size_t len) {
+    static const uint64_t secret[4] = {
+        UINT64_C(0xa0761d6478bd642f),
+        UINT64_C(0xe7037ed1a0b428db),
+        UINT64_C(0x8ebc6af09c88c6e3),
+        UINT64_C(0x589965cc75374cc3),
+    };
+    const uint8_t *p    = data;
+    uint64_t       seed = mp_hash_mix(secret[0], secret[1]);
+    uint64_t       a, b;
 
-    va_start(args, fmt);
-    int len = vsnprintf(NULL, 0, fmt, args);
-    MEMPLUS_ASSERT(len >= 0 && "failed to count string length");
-    va_end(args);
+    if (len <= 16) {
+        if (len >= 4) {
+            size_t offset = (len >> 3) << 2;
+            a             = (mp_read32(p) << 32) | mp_read32(p + offset);
+            b             = (mp_read32(p + len - 4) << 32) | mp_read32(p + len - 4 - offset);
+        } else if (len > 0) {
+            a = ((uint64_t) p[0] << 16) | ((uint64_t) p[len >> 1] << 8) | p[len - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = len;
+        if (i > 48) {
+            uint64_t seed1 = seed, seed2 = seed;
+            do {
+                seed  = mp_hash_mix(mp_read64(p) ^ secret[1], mp_read64(p + 8) ^ seed);
+                seed1 = mp_hash_mix(mp_read64(p + 16) ^ secret[2], mp_read64(p + 24) ^ seed1);
+                seed2 = mp_hash_mix(mp_read64(p + 32) ^ secret[3], mp_read64(p + 40) ^ seed2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= seed1 ^ seed2;
+        }
+        while (i > 16) {
+            seed = mp_hash_mix(mp_read64(p) ^ secret[1], mp_read64(p + 8) ^ seed);
+            p += 16;
+            i -= 16;
+        }
+        a = mp_read64(p + i - 16);
+        b = mp_read64(p + i - 8);
+    }
+    return mp_hash_mix(secret[1] ^ len, mp_hash_mix(a ^ secret[1], b ^ seed));
+}
 
-    char *result = mp_alloc(allocator, len + 1);
-    if (result == NULL) return (mp_String){ 0, NULL };
+void mp_interner_init(mp_Interner *self, mp_Allocator *allocator) {
+    mp_arena_init(&self->arena);
+    self->alloc = allocator;
+    self->len   = 0;
+    self->cap   = 0;
+    self->slots = NULL;
+}
 
-    va_start(args, fmt);
-    int result_len = vsnprintf(result, len + 1, fmt, args);
-    MEMPLUS_ASSERT(result_len == len);
-    va_end(args);
+void mp_interner_destroy(mp_Interner *self) {
+    mp_arena_destroy(&self->arena);
+    if (self->slots != NULL) mp_free(self->alloc, self->slots);
+    self->alloc = NULL;
+    self->len   = 0;
+    self->cap   = 0;
+    self->slots = NULL;
+}
 
-    return (mp_String){ result_len, result };
+/* Each string is stored in the arena right after its length. */
+static size_t mp_interned_len(const char *cstr) {
+    size_t len;
+    memcpy(&len, cstr - sizeof(size_t), sizeof(size_t));
+    return len;
 }
 
-mp_String mp_string_dup(const mp_Allocator *allocator, mp_String str) {
-    int len = snprintf(NULL, 0, "%s", str.cstr);
-    MEMPLUS_ASSERT((len >= 0 || (size_t) len != str.len) && "failed to count string length");
-    char *ptr = mp_dup(allocator, str.cstr, len);
-    if (ptr == NULL) return (mp_String){ 0, NULL };
-    return (mp_String){ len, ptr };
+static bool mp_interner_grow(mp_Interner *self) {
+    size_t         cap   = self->cap == 0 ? MP_INTERNER_INIT_CAPACITY : self->cap * 2;
+    mp_InternSlot *slots = mp_alloc(self->alloc, cap * sizeof(mp_InternSlot));
+    if (slots == NULL) return false;
+    memset(slots, 0, cap * sizeof(mp_InternSlot));
+    for (size_t i = 0; i < self->cap; ++i) {
+        if (self->slots[i].cstr == NULL) continue;
+        size_t j = self->slots[i].hash & (cap - 1);
+        while (slots[j].cstr != NULL)
+            j = (j + 1) & (cap - 1);
+        slots[j] = self->slots[i];
+    }
+    if (self->slots != NULL) mp_free(self->alloc, self->slots);
+    self->cap   = cap;
+    self->slots = slots;
+    return true;
 }
 
-void mp_string_destroy(const mp_Allocator *allocator, mp_String *str) {
-    mp_free(allocator, str->cstr);
-    str->len = 0;
+/* Returns the slot holding `str` or the empty slot where it belongs. */
+static mp_InternSlot *mp_interner_lookup(const mp_Interner *self, mp_Slice str, uint64_t hash) {
+    size_t mask = self->cap - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        mp_InternSlot *slot = &self->slots[i];
+        if (slot->cstr == NULL) return slot;
+        if (slot->hash == hash && mp_interned_len(slot->cstr) == str.len &&
+            memcmp(slot->cstr, str.ptr, str.len) == 0)
+            return slot;
+    }
+}
+
+mp_String mp_interner_intern(mp_Interner *self, mp_Slice str) {
+    return mp_interner_intern_hashed(self, str, mp_hash(str.ptr, str.len));
+}
+
+mp_String mp_interner_intern_hashed(mp_Interner *self, mp_Slice str, uint64_t hash) {
+    if (self->cap == 0 && !mp_interner_grow(self)) return (mp_String){ 0, NULL };
+    mp_InternSlot *slot = mp_interner_lookup(self, str, hash);
+    if (slot->cstr == NULL) {
+        // Keeps the load factor at or below 3/4, only strings that are not interned yet grow it
+        if ((self->len + 1) * 4 > self->cap * 3) {
+            if (!mp_interner_grow(self)) return (mp_String){ 0, NULL };
+            slot = mp_interner_lookup(self, str, hash);
+        }
+        char *cstr = mp_arena_alloc(&self->arena, sizeof(size_t) + str.len + 1);
+        if (cstr == NULL) return (mp_String){ 0, NULL };
+        memcpy(cstr, &str.len, sizeof(size_t));
+        cstr += sizeof(size_t);
+        if (str.len > 0) memcpy(cstr, str.ptr, str.len);
+        cstr[str.len] = '\0';
+        slot->hash    = hash;
+        slot->cstr    = cstr;
+        ++self->len;
+    }
+    return (mp_String){ str.len, (char *) slot->cstr };
+}
+
+bool mp_interner_intern_many(mp_Interner   *self,
+                             const mp_Slice *strs,
+                             size_t          amount,
+                             mp_String      *output) {
+    // Grows the index once up front instead of during the loop
+    while ((self->len + amount) * 4 > self->cap * 3)
+        if (!mp_interner_grow(self)) return false;
+    for (size_t i = 0; i < amount; ++i) {
+        output[i] = mp_interner_intern(self, strs[i]);
+        if (output[i].cstr == NULL) return false;
+    }
+    return true;
+}
+
+mp_String mp_interner_find(const mp_Interner *self, mp_Slice str) {
+    if (self->len == 0) return (mp_String){ 0, NULL };
+    mp_InternSlot *slot = mp_interner_lookup(self, str, mp_hash(str.ptr, str.len));
+    return (mp_String){ slot->cstr ? str.len : 0, (char *) slot->cstr };
+}
+
+#if defined(MEMPLUS_POSIX) && !defined(MEMPLUS_NO_THREADS)
+void mp_shared_interner_init(mp_SharedInterner *self, mp_Allocator *allocator) {
+    for (size_t i = 0; i < MP_INTERNER_SHARDS; ++i) {
+        pthread_mutex_init(&self->shards[i].lock, NULL);
+        mp_interner_init(&self->shards[i].interner, allocator);
+    }
+}
+
+void mp_shared_interner_destroy(mp_SharedInterner *self) {
+    for (size_t i = 0; i < MP_INTERNER_SHARDS; ++i) {
+        mp_interner_destroy(&self->shards[i].interner);
+        pthread_mutex_destroy(&self->shards[i].lock);
+    }
+}
+
+mp_String mp_shared_interner_intern(mp_SharedInterner *self, mp_Slice str) {
+    return mp_shared_interner_intern_hashed(self, str, mp_hash(str.ptr, str.len));
+}
+
+mp_String mp_shared_interner_intern_hashed(mp_SharedInterner *self, mp_Slice str, uint64_t hash) {
+    // The index uses the low bits of the hash, so the shard is picked with the high bits
+    mp_InternerShard *shard = &self->shards[(hash >> 32) & (MP_INTERNER_SHARDS - 1)];
+    pthread_mutex_lock(&shard->lock);
+    mp_String result = mp_interner_intern_hashed(&shard->interner, str, hash);
+    pthread_mutex_unlock(&shard->lock);
+    return result;
+}
+#endif /* if defined(MEMPLUS_POSIX) && !defined(MEMPLUS_NO_THREADS) */
+
+/* Sorts `data` by 8-bit digits, least significant first, using `buf` as the other half of the
+ * ping-pong buffer. Digits that are the same for every key are skipped.
+ * The sorted result is always copied back to the array `data` initially pointed to. */
+#define MP_RADIX_SORT_IMPL(key_type, data, buf, len, get_key)                                      \
+    do {                                                                                           \
+        enum { DIGITS = sizeof(key_type) };                                                        \
+        size_t counts[DIGITS][256];                                                                \
+        memset(counts, 0, sizeof(counts));                                                         \
+        for (size_t i = 0; i < (len); ++i) {                                                       \
+            key_type k = get_key((data)[i]);                                                       \
+            for (size_t d = 0; d < DIGITS; ++d)                                                    \
+                ++counts[d][(k >> (d * 8)) & 0xff];                                                \
+        }                                                                                          \
+                                                                                                   \
+        bool swapped = false;                                                                      \
+        for (size_t d = 0; d < DIGITS; ++d) {                                                      \
+            size_t *count = counts[d];                                                             \
+            key_type first = get_key((data)[0]);                                                   \
+            if (count[(first >> (d * 8)) & 0xff] == (len)) continue;                               \
+                                                                                                   \
+            size_t offset = 0;                                                                     \
+            for (size_t b = 0; b < 256; ++b) {                                                     \
+                size_t c = count[b];                                                               \
+                count[b] = offset;                                                                 \
+                offset += c;                                                                       \
+            }                                                                                      \
+            for (size_t i = 0; i < (len); ++i)                                                     \
+                (buf)[count[(get_key((data)[i]) >> (d * 8)) & 0xff]++] = (data)[i];                \
+                                                                                                   \
+            void *temp = (data);                                                                   \
+            (data)     = (buf);                                                                    \
+            (buf)      = temp;                                                                     \
+            swapped    = !swapped;                                                                 \
+        }                                                                                          \
+        if (swapped) memcpy((buf), (data), (len) * sizeof(*(data)));                               \
+    } while (0)
+
+#define MP_RADIX_KEY_SELF(item) (item)
+#define MP_RADIX_KEY_PAIR(item) ((item).key)
+
+typedef struct {
+    uint64_t key;
+    size_t   index;
+} mp_RadixPair;
+
+bool mp_radix_sort_u32(uint32_t *data, size_t len, const mp_Allocator *scratch) {
+    if (len < 2) return true;
+    uint32_t *buf = mp_alloc(scratch, len * sizeof(*data));
+    if (buf == NULL) return false;
+    uint32_t *scratch_buf = buf;
+    MP_RADIX_SORT_IMPL(uint32_t, data, buf, len, MP_RADIX_KEY_SELF);
+    mp_free(scratch, scratch_buf);
+    return true;
+}
+
+bool mp_radix_sort_u64(uint64_t *data, size_t len, const mp_Allocator *scratch) {
+    if (len < 2) return true;
+    uint64_t *buf = mp_alloc(scratch, len * sizeof(*data));
+    if (buf == NULL) return false;
+    uint64_t *scratch_buf = buf;
+    MP_RADIX_SORT_IMPL(uint64_t, data, buf, len, MP_RADIX_KEY_SELF);
+    mp_free(scratch, scratch_buf);
+    return true;
+}
+
+bool mp_radix_sort_i32(int32_t *data, size_t len, const mp_Allocator *scratch) {
+    // Flipping the sign bit maps two's complement order to unsigned order
+    uint32_t *keys = (uint32_t *) data;
+    for (size_t i = 0; i < len; ++i)
+        keys[i] ^= UINT32_C(1) << 31;
+    bool result = mp_radix_sort_u32(keys, len, scratch);
+    for (size_t i = 0; i < len; ++i)
+        keys[i] ^= UINT32_C(1) << 31;
+    return result;
+}
+
+bool mp_radix_sort_i64(int64_t *data, size_t len, const mp_Allocator *scratch) {
+    uint64_t *keys = (uint64_t *) data;
+    for (size_t i = 0; i < len; ++i)
+        keys[i] ^= UINT64_C(1) << 63;
+    bool result = mp_radix_sort_u64(keys, len, scratch);
+    for (size_t i = 0; i < len; ++i)
+        keys[i] ^= UINT64_C(1) << 63;
+    return result;
+}
+
+/* Maps floats to unsigned keys in the same order: negative numbers have all bits flipped, positive
+ * numbers only the sign bit. The bits are read with memcpy to stay within the aliasing rules. */
+static inline uint32_t mp_radix_key_f32(float item) {
+    uint32_t key;
+    memcpy(&key, &item, sizeof(key));
+    return (key & (UINT32_C(1) << 31)) ? ~key : key ^ (UINT32_C(1) << 31);
 }
 
+static inline uint64_t mp_radix_key_f64(double item) {
+    uint64_t key;
+    memcpy(&key, &item, sizeof(key));
+    return (key & (UINT64_C(1) << 63)) ? ~key : key ^ (UINT64_C(1) << 63);
+}
+
+bool mp_radix_sort_f32(float *data, size_t len, const mp_Allocator *scratch) {
+    if (len < 2) return true;
+    float *buf = mp_alloc(scratch, len * sizeof(*data));
+    if (buf == NULL) return false;
+    float *scratch_buf = buf;
+    MP_RADIX_SORT_IMPL(uint32_t, data, buf, len, mp_radix_key_f32);
+    mp_free(scratch, scratch_buf);
+    return true;
+}
+
+bool mp_radix_sort_f64(double *data, size_t len, const mp_Allocator *scratch) {
+    if (len < 2) return true;
+    double *buf = mp_alloc(scratch, len * sizeof(*data));
+    if (buf == NULL) return false;
+    double *scratch_buf = buf;
+    MP_RADIX_SORT_IMPL(uint64_t, data, buf, len, mp_radix_key_f64);
+    mp_free(scratch, scratch_buf);
+    return true;
+}
+
+bool mp_radix_sort_key(void               *data,
+                       size_t              len,
+                       size_t              size,
+                       uint64_t            (*key)(const void *item),
+                       const mp_Allocator *scratch) {
+    if (len < 2) return true;
+    mp_RadixPair *pairs = mp_alloc(scratch, 2 * len * sizeof(mp_RadixPair) + len * size);
+    if (pairs == NULL) return false;
+    mp_RadixPair *buf   = pairs + len;
+    uint8_t      *items = (uint8_t *) (pairs + 2 * len);
+    uint8_t      *bytes = data;
+
+    mp_RadixPair *sorted = pairs;
+    for (size_t i = 0; i < len; ++i)
+        sorted[i] = (mp_RadixPair){ key(bytes + i * size), i };
+    MP_RADIX_SORT_IMPL(uint64_t, sorted, buf, len, MP_RADIX_KEY_PAIR);
+
+    for (size_t i = 0; i < len; ++i)
+        memcpy(items + i * size, bytes + sorted[i].index * size, size);
+    memcpy(data, items, len * size);
+    mp_free(scratch, pairs);
+    return true;
+}
+
+#undef MP_RADIX_SORT_IMPL
+#undef MP_RADIX_KEY_SELF
+#undef MP_RADIX_KEY_PAIR
+
+void mp_bitset_init(mp_Bitset *self, mp_Allocator *allocator) {
+    mp_vector_init(self, allocator);
+    self->bits = 0;
+}
+
+void mp_bitset_destroy(mp_Bitset *self) {
+    mp_vector_destroy(self);
+    self->bits = 0;
+}
+
+/* Clears the bits past `bits` in the last word. */
+static void mp_bitset_clear_tail(mp_Bitset *self) {
+    if (self->bits % 64 != 0) self->data[self->len - 1] &= ~(~UINT64_C(0) << (self->bits % 64));
+}
+
+bool mp_bitset_resize(mp_Bitset *self, size_t bits) {
+    size_t old_len = self->len;
+    size_t len     = (bits + 63) / 64;
+    bool   shrink  = bits < self->bits;
+    mp_resize(self, (ptrdiff_t) len - (ptrdiff_t) old_len);
+    if (self->data == NULL && len > 0) return false;
+    if (len > old_len) memset(self->data + old_len, 0, (len - old_len) * sizeof(uint64_t));
+    self->bits = bits;
+    if (shrink && len > 0) mp_bitset_clear_tail(self);
+    return true;
+}
+
+void mp_bitset_fill(mp_Bitset *self, bool value) {
+    if (self->len == 0) return;
+    memset(self->data, value ? 0xff : 0, self->len * sizeof(uint64_t));
+    mp_bitset_clear_tail(self);
+}
+
+#if defined(__AVX2__)
+#define MP_BITSET_OP(name, op, simd_op, simd_a, simd_b)                                            \
+    void name(mp_Bitset *self, const mp_Bitset *other) {                                           \
+        MEMPLUS_ASSERT(self->bits == other->bits && "bitset sizes differ");                        \
+        uint64_t       *a = self->data;                                                            \
+        const uint64_t *b = other->data;                                                           \
+        size_t          i = 0;                                                                     \
+        for (; i + 4 <= self->len; i += 4) {                                                       \
+            __m256i x = _mm256_loadu_si256((const __m256i *) (a + i));                             \
+            __m256i y = _mm256_loadu_si256((const __m256i *) (b + i));                             \
+            _mm256_storeu_si256((__m256i *) (a + i), _mm256_##simd_op##_si256(simd_a, simd_b));    \
+        }                                                                                          \
+        for (; i < self->len; ++i)                                                                 \
+            a[i] = op;                                                                             \
+    }
+#elif defined(__SSE2__)
+#define MP_BITSET_OP(name, op, simd_op, simd_a, simd_b)                                            \
+    void name(mp_Bitset *self, const mp_Bitset *other) {                                           \
+        MEMPLUS_ASSERT(self->bits == other->bits && "bitset sizes differ");                        \
+        uint64_t       *a = self->data;                                                            \
+        const uint64_t *b = other->data;                                                           \
+        size_t          i = 0;                                                                     \
+        for (; i + 2 <= self->len; i += 2) {                                                       \
+            __m128i x = _mm_loadu_si128((const __m128i *) (a + i));                                \
+            __m128i y = _mm_loadu_si128((const __m128i *) (b + i));                                \
+            _mm_storeu_si128((__m128i *) (a + i), _mm_##simd_op##_si128(simd_a, simd_b));          \
+        }                                                                                          \
+        for (; i < self->len; ++i)                                                                 \
+            a[i] = op;                                                                             \
+    }
+#else
+#define MP_BITSET_OP(name, op, simd_op, simd_a, simd_b)                                            \
+    void name(mp_Bitset *self, const mp_Bitset *other) {                                           \
+        MEMPLUS_ASSERT(self->bits == other->bits && "bitset sizes differ");                        \
+        uint64_t       *a = self->data;                                                            \
+        const uint64_t *b = other->data;                                                           \
+        for (size_t i = 0; i < self->len; ++i)                                                     \
+            a[i] = op;                                                                             \
+    }
+#endif
+
+MP_BITSET_OP(mp_bitset_and, a[i] & b[i], and, x, y)
+MP_BITSET_OP(mp_bitset_or, a[i] | b[i], or, x, y)
+MP_BITSET_OP(mp_bitset_xor, a[i] ^ b[i], xor, x, y)
+// The SIMD andnot negates its first operand
+MP_BITSET_OP(mp_bitset_andnot, a[i] & ~b[i], andnot, y, x)
+
+#undef MP_BITSET_OP
+
+size_t mp_bitset_count(const mp_Bitset *self) {
+    // Independent accumulators let the popcounts overlap
+    size_t counts[4] = { 0 };
+    size_t i         = 0;
+    for (; i + 4 <= self->len; i += 4) {
+        counts[0] += mp_popcount64(self->data[i]);
+        counts[1] += mp_popcount64(self->data[i + 1]);
+        counts[2] += mp_popcount64(self->data[i + 2]);
+        counts[3] += mp_popcount64(self->data[i + 3]);
+    }
+    for (; i < self->len; ++i)
+        counts[0] += mp_popcount64(self->data[i]);
+    return counts[0] + counts[1] + counts[2] + counts[3];
+}
+
+size_t mp_bitset_rank(const mp_Bitset *self, size_t i) {
+    MEMPLUS_ASSERT(i <= self->bits && "index out of bounds");
+    size_t result = 0;
+    size_t words  = i / 64;
+    for (size_t w = 0; w < words; ++w)
+        result += mp_popcount64(self->data[w]);
+    if (i % 64 != 0) result += mp_popcount64(self->data[words] & ~(~UINT64_C(0) << (i % 64)));
+    return result;
+}
+
+size_t mp_bitset_find_next(const mp_Bitset *self, size_t i) {
+    if (i >= self->bits) return self->bits;
+    size_t   w    = i / 64;
+    uint64_t word = self->data[w] & (~UINT64_C(0) << (i % 64));
+    while (word == 0) {
+        if (++w == self->len) return self->bits;
+        word = self->data[w];
+    }
+    return w * 64 + mp_ctz64(word);
+}
+
+bool mp_relstring_init(mp_RelString *self, const mp_Allocator *allocator, mp_Slice str) {
+    char *cstr = mp_alloc(allocator, str.len + 1);
+    if (cstr == NULL) return false;
+    if (str.len > 0) memcpy(cstr, str.ptr, str.len);
+    cstr[str.len] = '\0';
+    self->len     = str.len;
+    mp_relptr_set(&self->cstr, cstr);
+    return true;
+}
+
+mp_String mp_relstring_get(const mp_RelString *self) {
+    return (mp_String){ self->len, mp_relptr_get(&self->cstr) };
+}
+
+bool mp_snapshot_save(const mp_SArena *arena, const char *file_path) {
+    bool              result = true;
+    size_t            len    = arena->len * sizeof(uintptr_t);
+    mp_SnapshotHeader header = { 0 };
+    memcpy(header.magic, MP_SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version   = MP_SNAPSHOT_VERSION;
+    header.word_size = sizeof(uintptr_t);
+    header.len       = len;
+    header.checksum  = mp_hash(arena->buf, len);
+
+    FILE *file = fopen(file_path, "wb");
+    if (file == NULL) return false;
+    if (fwrite(&header, sizeof(header), 1, file) != 1) return_defer(false);
+    if (len > 0 && fwrite(arena->buf, len, 1, file) != 1) return_defer(false);
+
+defer:
+    if (fclose(file) != 0) result = false;
+    return result;
+}
+
+#ifdef MEMPLUS_POSIX
+bool mp_snapshot_load(mp_Snapshot *self, const char *file_path, bool verify) {
+    mp_Slice map;
+    if (!mp_map_file(&map, file_path, 0)) return false;
+
+    const mp_SnapshotHeader *header = (const mp_SnapshotHeader *) map.ptr;
+    const char              *data   = map.ptr + sizeof(mp_SnapshotHeader);
+    if (map.len < sizeof(mp_SnapshotHeader) ||
+        memcmp(header->magic, MP_SNAPSHOT_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != MP_SNAPSHOT_VERSION || header->word_size != sizeof(uintptr_t) ||
+        header->len != map.len - sizeof(mp_SnapshotHeader) ||
+        (verify && mp_hash(data, header->len) != header->checksum)) {
+        mp_unmap_file(&map);
+        errno = EINVAL;
+        return false;
+    }
+
+    self->map  = map;
+    self->data = data;
+    self->len  = header->len;
+    return true;
+}
+
+void mp_snapshot_unload(mp_Snapshot *self) {
+    mp_unmap_file(&self->map);
+    self->data = NULL;
+    self->len  = 0;
+}
+#endif /* ifdef MEMPLUS_POSIX */
+
+#ifdef MEMPLUS_POSIX
+bool mp_read_entire_file(mp_Allocator *allocator, mp_String *output, const char *file_path) {
+    bool   result = true;
+    char  *buffer = NULL;
+    size_t len    = 0;
+    size_t cap    = 0;
+
+    int fd = open(file_path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) return_defer(false);
+    // Pipes and special files have no size, so the buffer is grown as they are read
+    cap    = S_ISREG(st.st_mode) ? (size_t) st.st_size : 4096;
+    buffer = mp_alloc(allocator, cap + 1);
+    if (buffer == NULL) return_defer(false);
+
+    for (;;) {
+        if (len == cap) {
+            if (S_ISREG(st.st_mode)) break;
+            char *new_buffer = mp_realloc(allocator, buffer, cap + 1, cap * 2 + 1);
+            if (new_buffer == NULL) return_defer(false);
+            buffer = new_buffer;
+            cap *= 2;
+        }
+        ssize_t bytes_read = read(fd, buffer + len, cap - len);
+        if (bytes_read < 0) return_defer(false);
+        if (bytes_read == 0) break;
+        len += bytes_read;
+    }
+    buffer[len] = '\0';
+    *output     = (mp_String){ len, buffer };
+
+defer:
+    if (!result && buffer != NULL) mp_free(allocator, buffer);
+    close(fd);
+    return result;
+}
+
+bool mp_map_file(mp_Slice *output, const char *file_path, int hints) {
+    bool result = true;
+
+    int fd = open(file_path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) return_defer(false);
+    if (st.st_size == 0) {
+        *output = (mp_Slice){ 0, NULL };
+        return_defer(true);
+    }
+
+    void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) return_defer(false);
+    // The hints are only advice, failing to apply them is not an error
+#ifdef POSIX_MADV_SEQUENTIAL
+    if (hints & MP_MAP_SEQUENTIAL) posix_madvise(data, st.st_size, POSIX_MADV_SEQUENTIAL);
+    if (hints & MP_MAP_WILLNEED) posix_madvise(data, st.st_size, POSIX_MADV_WILLNEED);
+#else
+    (void) hints;
+#endif
+    *output = (mp_Slice){ st.st_size, data };
+
+defer:
+    // The mapping stays valid after the file is closed
+    close(fd);
+    return result;
+}
+
+void mp_unmap_file(mp_Slice *map) {
+    if (map->len > 0) munmap((void *) map->ptr, map->len);
+    *map = (mp_Slice){ 0, NULL };
+}
+#else
 bool mp_read_entire_file(mp_Allocator *allocator, mp_String *output, const char *file_path) {
-    bool         result     = true;
-    mp_Allocator heap_alloc = mp_heap_allocator();
-    char        *buffer     = NULL;
+    bool  result = true;
+    char *buffer = NULL;
 
-    FILE *file = fopen(file_path, "r");
+    FILE *file = fopen(file_path, "rb");
     if (file == NULL) return false;
 
     if (fseek(file, 0, SEEK_END) < 0) return_defer(false);
     long file_size = ftell(file);
     if (file_size < 0) return_defer(false);
     if (fseek(file, 0, SEEK_SET) < 0) return_defer(false);
-    buffer = mp_alloc(&heap_alloc, file_size + 1);
+    buffer = mp_alloc(allocator, file_size + 1);
     if (buffer == NULL) return_defer(false);
     long bytes_read = fread(buffer, 1, file_size, file);
     if (bytes_read != file_size || ferror(file) != 0) return_defer(false);
     buffer[file_size] = '\0';
-    *output           = mp_string_new(allocator, buffer);
+    *output           = (mp_String){ file_size, buffer };
 
 defer:
-    mp_free(&heap_alloc, buffer);
+    if (!result && buffer != NULL) mp_free(allocator, buffer);
     fclose(file);
     return result;
 }
+#endif /* ifdef MEMPLUS_POSIX */
+
+bool mp_file_reader_init(mp_FileReader *self,
+                         mp_Allocator  *allocator,
+                         FILE          *file,
+                         size_t         buffer_size) {
+    if (buffer_size == 0) buffer_size = MP_FILE_READER_BUFFER_SIZE;
+    self->buf = mp_alloc(allocator, buffer_size);
+    if (self->buf == NULL) return false;
+    self->alloc     = allocator;
+    self->file      = file;
+    self->owns_file = false;
+    self->eof       = false;
+    self->error     = false;
+    self->begin     = 0;
+    self->scanned   = 0;
+    self->end       = 0;
+    self->cap       = buffer_size;
+    return true;
+}
+
+bool mp_file_reader_open(mp_FileReader *self,
+                         mp_Allocator  *allocator,
+                         const char    *file_path,
+                         size_t         buffer_size) {
+    FILE *file = fopen(file_path, "rb");
+    if (file == NULL) return false;
+    // The reader does its own buffering
+    setvbuf(file, NULL, _IONBF, 0);
+    if (!mp_file_reader_init(self, allocator, file, buffer_size)) {
+        fclose(file);
+        return false;
+    }
+    self->owns_file = true;
+    return true;
+}
+
+void mp_file_reader_close(mp_FileReader *self) {
+    mp_free(self->alloc, self->buf);
+    if (self->owns_file) fclose(self->file);
+    self->file = NULL;
+    self->buf  = NULL;
+    self->cap  = 0;
+}
+
+bool mp_file_reader_next(mp_FileReader *self, char delim, mp_Slice *record) {
+    for (;;) {
+        const char *found = memchr(self->buf + self->scanned, delim, self->end - self->scanned);
+        if (found != NULL) {
+            size_t record_end = found - self->buf;
+            *record           = (mp_Slice){ record_end - self->begin, self->buf + self->begin };
+            self->begin       = record_end + 1;
+            self->scanned     = self->begin;
+            return true;
+        }
+        self->scanned = self->end;
+
+        if (self->error) return false;
+        if (self->eof) {
+            if (self->begin == self->end) return false;
+            *record     = (mp_Slice){ self->end - self->begin, self->buf + self->begin };
+            self->begin = self->end;
+            return true;
+        }
+
+        // Moves the partial record to the front, or grows the buffer if it fills the buffer
+        if (self->begin > 0) {
+            memmove(self->buf, self->buf + self->begin, self->end - self->begin);
+            self->end -= self->begin;
+            self->begin   = 0;
+            self->scanned = self->end;
+        } else if (self->end == self->cap) {
+            char *buf = mp_realloc(self->alloc, self->buf, self->cap, self->cap * 2);
+            if (buf == NULL) {
+                self->error = true;
+                return false;
+            }
+            self->buf = buf;
+            self->cap *= 2;
+        }
+
+        size_t bytes_read = fread(self->buf + self->end, 1, self->cap - self->end, self->file);
+        self->end += bytes_read;
+        if (bytes_read == 0) {
+            self->eof   = true;
+            self->error = ferror(self->file) != 0;
+        }
+    }
+}
+
+bool mp_file_reader_next_line(mp_FileReader *self, mp_Slice *line) {
+    if (!mp_file_reader_next(self, '\n', line)) return false;
+    if (line->len > 0 && line->ptr[line->len - 1] == '\r') --line->len;
+    return true;
+}
+
+#if defined(MEMPLUS_POSIX) && !defined(MEMPLUS_NO_THREADS)
+typedef struct {
+    mp_Allocator      *allocator;    // The caller's allocator
+    mp_Allocator       shared;       // Allocator used by the workers
+    pthread_mutex_t    lock;         // Serializes calls to `allocator` through `shared`
+    const char *const *file_paths;
+    size_t             amount;
+    mp_String         *outputs;
+    int               *errors;
+    atomic_size_t      next;    // The next file to be claimed by a worker
+} mp_ReadFilesJob;
+
+typedef struct {
+    mp_ReadFilesJob *job;
+    pthread_t        thread;
+    bool             spawned;
+} mp_ReadFilesWorker;
+
+/* Functions of the allocator given to the workers. They forward to the caller's allocator one at a
+ * time, so the workers read into the final buffers while only the allocations are serialized. */
+static void *mp_read_files_alloc(void *context, size_t size) {
+    mp_ReadFilesJob *job = context;
+    pthread_mutex_lock(&job->lock);
+    void *result = mp_alloc(job->allocator, size);
+    pthread_mutex_unlock(&job->lock);
+    return result;
+}
+
+static void *mp_read_files_realloc(void *context, void *old_ptr, size_t old_size, size_t new_size) {
+    mp_ReadFilesJob *job = context;
+    pthread_mutex_lock(&job->lock);
+    void *result = mp_realloc(job->allocator, old_ptr, old_size, new_size);
+    pthread_mutex_unlock(&job->lock);
+    return result;
+}
+
+static void *mp_read_files_dup(void *context, void *data, size_t size) {
+    mp_ReadFilesJob *job = context;
+    pthread_mutex_lock(&job->lock);
+    void *result = mp_dup(job->allocator, data, size);
+    pthread_mutex_unlock(&job->lock);
+    return result;
+}
+
+static void mp_read_files_free(void *context, void *ptr) {
+    mp_ReadFilesJob *job = context;
+    pthread_mutex_lock(&job->lock);
+    mp_free(job->allocator, ptr);
+    pthread_mutex_unlock(&job->lock);
+}
+
+static void *mp_read_files_worker(void *arg) {
+    mp_ReadFilesWorker *self = arg;
+    mp_ReadFilesJob    *job  = self->job;
+    for (;;) {
+        size_t i = atomic_fetch_add_explicit(&job->next, 1, memory_order_relaxed);
+        if (i >= job->amount) break;
+        errno = 0;
+        if (mp_read_entire_file(&job->shared, &job->outputs[i], job->file_paths[i])) {
+            job->errors[i] = 0;
+        } else {
+            job->errors[i]  = errno != 0 ? errno : EIO;
+            job->outputs[i] = (mp_String){ 0, NULL };
+        }
+    }
+    return NULL;
+}
+
+size_t mp_read_files(mp_Allocator      *allocator,
+                     const char *const *file_paths,
+                     size_t             amount,
+                     mp_String         *outputs,
+                     int               *errors,
+                     size_t             threads) {
+    if (threads == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads   = cpus > 0 ? (size_t) cpus : 1;
+        if (threads > MP_READ_FILES_MAX_THREADS) threads = MP_READ_FILES_MAX_THREADS;
+    }
+    if (threads > amount) threads = amount;
+    if (threads == 0) return 0;
+
+    mp_ReadFilesJob job;
+    job.allocator  = allocator;
+    job.file_paths = file_paths;
+    job.amount     = amount;
+    job.outputs    = outputs;
+    job.errors     = errors;
+    atomic_init(&job.next, 0);
+
+    mp_Allocator        heap = mp_heap_allocator();
+    mp_ReadFilesWorker  main_worker;
+    mp_ReadFilesWorker *workers = NULL;
+    if (threads > 1) workers = mp_alloc(&heap, threads * sizeof(mp_ReadFilesWorker));
+    if (workers != NULL && pthread_mutex_init(&job.lock, NULL) != 0) {
+        mp_free(&heap, workers);
+        workers = NULL;
+    }
+    if (workers == NULL) {
+        workers = &main_worker;
+        threads = 1;
+    }
+    // A single worker does not need to lock around the caller's allocator
+    job.shared = threads == 1 ? *allocator
+                              : mp_allocator_new(&job,
+                                                 mp_read_files_alloc,
+                                                 mp_read_files_realloc,
+                                                 mp_read_files_dup,
+                                                 mp_read_files_free);
+
+    // The calling thread works as the first worker.
+    // If a thread fails to spawn, the other workers pick up its files.
+    for (size_t i = 0; i < threads; ++i) {
+        workers[i].job     = &job;
+        workers[i].spawned = i > 0 && pthread_create(&workers[i].thread,
+                                                     NULL,
+                                                     mp_read_files_worker,
+                                                     &workers[i]) == 0;
+    }
+    mp_read_files_worker(&workers[0]);
+    for (size_t i = 1; i < threads; ++i)
+        if (workers[i].spawned) pthread_join(workers[i].thread, NULL);
+
+    size_t result = 0;
+    for (size_t i = 0; i < amount; ++i)
+        if (errors[i] != 0) ++result;
+
+    if (workers != &main_worker) {
+        pthread_mutex_destroy(&job.lock);
+        mp_free(&heap, workers);
+    }
+    return result;
+}
+#endif
+
+#undef MP_AVX2_DISPATCH
+#undef MP_TARGET_AVX2
 
 #endif /* ifdef MEMPLUS_IMPLEMENTATION */
 
@@ -1,5 +1,50 @@
 #include "test.h"
 
+#include <pthread.h>
+
+#define MESSAGES 100000
+
+typedef struct {
+    size_t  len;
+    uint8_t data[];
+} Message;
+
+mp_spsc_create(Queue_Message, Message *);
+
+typedef struct {
+    mp_Allocator  *alloc;
+    Queue_Message *queue;
+} Channel;
+
+// Allocates messages of different sizes and hands them to the consumer, who frees them
+void *producer(void *arg) {
+    Channel *channel = arg;
+    for (size_t i = 0; i < MESSAGES; ++i) {
+        size_t   len     = i % 300;
+        Message *message = mp_alloc(channel->alloc, sizeof(Message) + len);
+        expects(message != NULL, "producer failed to allocate");
+        for (size_t j = 0; j < len; ++j)
+            expectf(message->data[j] == 0, "memory is not zeroed at %zu", j);
+        message->len = len;
+        memset(message->data, (uint8_t) i, len);
+        while (!Queue_Message_push(channel->queue, message)) {}
+    }
+    return NULL;
+}
+
+void *consumer(void *arg) {
+    Channel *channel = arg;
+    for (size_t i = 0; i < MESSAGES; ++i) {
+        Message *message;
+        while (!Queue_Message_pop(channel->queue, &message)) {}
+        expectf(message->len == i % 300, "message %zu has length %zu", i, message->len);
+        for (size_t j = 0; j < message->len; ++j)
+            expectf(message->data[j] == (uint8_t) i, "message %zu is corrupted at %zu", i, j);
+        mp_free(channel->alloc, message);
+    }
+    return NULL;
+}
+
 void test(mp_Allocator *alloc, size_t *size) {
     int32_t *test1, *test2;
     int64_t *test3;
@@ -21,6 +66,19 @@ void test(mp_Allocator *alloc, size_t *size) {
 
     mp_free(alloc, test1);
     mp_free(alloc, test3);
+
+    if (size) {
+        // Arenas grow their last allocation in place
+        int32_t *test4 = mp_alloc(alloc, 4 * sizeof(int32_t));
+        test4[3]       = 1337;
+        int32_t *test5 = mp_realloc(alloc, test4, 4 * sizeof(int32_t), 32 * sizeof(int32_t));
+        expectf(test5 == test4 && test5[3] == 1337,
+                "5(%d) %p -> %p, size %zu",
+                test5[3],
+                (void *) test4,
+                (void *) test5,
+                *size);
+    }
 }
 
 int main(void) {
@@ -56,6 +114,44 @@ int main(void) {
     alloc = mp_heap_allocator();
     test(&alloc, NULL);
 
+    /* THREAD CACHE ALLOCATOR */
+
+    mp_ThreadHeap thread_heap;
+    mp_thread_heap_init(&thread_heap);
+    alloc = mp_thread_heap_allocator(&thread_heap);
+    test(&alloc, NULL);
+
+    void *big = mp_alloc(&alloc, 1 << 20);
+    big       = mp_realloc(&alloc, big, 1 << 20, 4 << 20);
+    expects(big != NULL, "mp_thread_heap failed to allocate a big block");
+    mp_free(&alloc, big);
+
+    mp_Allocator  heap_alloc = mp_heap_allocator();
+    Queue_Message queues[2];
+    Channel       channels[2];
+    pthread_t     producers[2], consumers[2];
+    // The second round reuses the caches of the threads of the first round
+    for (int round = 0; round < 2; ++round) {
+        for (int i = 0; i < 2; ++i) {
+            Queue_Message_init(&queues[i], &heap_alloc, 1024);
+            channels[i] = (Channel){ &alloc, &queues[i] };
+            pthread_create(&producers[i], NULL, producer, &channels[i]);
+            pthread_create(&consumers[i], NULL, consumer, &channels[i]);
+        }
+        for (int i = 0; i < 2; ++i) {
+            pthread_join(producers[i], NULL);
+            pthread_join(consumers[i], NULL);
+            Queue_Message_destroy(&queues[i]);
+        }
+    }
+    // Consumers only free, so only the main thread and the producers of the first round own a cache
+    size_t caches = 0;
+    for (mp_ThreadCache *cache = thread_heap.caches; cache != NULL; cache = cache->next)
+        ++caches;
+    expectf(caches == 3, "mp_thread_heap: %zu caches", caches);
+
+    mp_thread_heap_destroy(&thread_heap);
+
     mp_sarena_destroy(&sarena);
     mp_arena_destroy(&arena);
 }
@@ -0,0 +1,72 @@
+#include "test.h"
+
+int main(void) {
+    mp_Arena arena;
+    mp_arena_init(&arena);
+    mp_Allocator alloc = mp_arena_allocator(&arena);
+
+    mp_Bitset a, b;
+    mp_bitset_init(&a, &alloc);
+    mp_bitset_init(&b, &alloc);
+    expects(mp_bitset_resize(&a, 1000) && mp_bitset_resize(&b, 1000), "mp_bitset_resize failed");
+    expectf(a.len == 16 && a.bits == 1000 && mp_bitset_count(&a) == 0,
+            "1(%zu;%zu) %zu bits",
+            a.len,
+            a.cap,
+            a.bits);
+
+    for (size_t i = 0; i < 1000; i += 3)
+        mp_bitset_set(&a, i);
+    for (size_t i = 0; i < 1000; i += 5)
+        mp_bitset_set(&b, i);
+    expectf(mp_bitset_count(&a) == 334 && mp_bitset_count(&b) == 200,
+            "mp_bitset_count: %zu %zu",
+            mp_bitset_count(&a),
+            mp_bitset_count(&b));
+    expects(mp_bitset_test(&a, 999) && !mp_bitset_test(&a, 998), "mp_bitset_test");
+    mp_bitset_clear(&a, 999);
+    expects(!mp_bitset_test(&a, 999), "mp_bitset_clear");
+    mp_bitset_set(&a, 999);
+
+    expectf(mp_bitset_rank(&a, 10) == 4 && mp_bitset_rank(&a, 1000) == 334,
+            "mp_bitset_rank: %zu %zu",
+            mp_bitset_rank(&a, 10),
+            mp_bitset_rank(&a, 1000));
+    expectf(mp_bitset_find_next(&a, 1) == 3 && mp_bitset_find_next(&a, 999) == 999,
+            "mp_bitset_find_next: %zu %zu",
+            mp_bitset_find_next(&a, 1),
+            mp_bitset_find_next(&a, 999));
+
+    size_t count = 0;
+    for (size_t i = mp_bitset_find_next(&b, 0); i < b.bits; i = mp_bitset_find_next(&b, i + 1))
+        ++count;
+    expectf(count == 200, "iterating with mp_bitset_find_next: %zu", count);
+
+    mp_Bitset c;
+    mp_bitset_init(&c, &alloc);
+    mp_bitset_resize(&c, 1000);
+    mp_bitset_or(&c, &a);
+    mp_bitset_and(&c, &b);
+    expectf(mp_bitset_count(&c) == 67, "mp_bitset_and: %zu", mp_bitset_count(&c));
+    mp_bitset_or(&c, &a);
+    mp_bitset_or(&c, &b);
+    expectf(mp_bitset_count(&c) == 334 + 200 - 67, "mp_bitset_or: %zu", mp_bitset_count(&c));
+    mp_bitset_andnot(&c, &b);
+    expectf(mp_bitset_count(&c) == 334 - 67, "mp_bitset_andnot: %zu", mp_bitset_count(&c));
+    mp_bitset_xor(&c, &a);
+    expectf(mp_bitset_count(&c) == 67, "mp_bitset_xor: %zu", mp_bitset_count(&c));
+
+    mp_bitset_fill(&c, true);
+    expectf(mp_bitset_count(&c) == 1000, "mp_bitset_fill: %zu", mp_bitset_count(&c));
+    expects(mp_bitset_resize(&c, 70), "mp_bitset_resize failed to shrink");
+    expectf(mp_bitset_count(&c) == 70 && c.len == 2, "shrink: %zu", mp_bitset_count(&c));
+    expects(mp_bitset_resize(&c, 200), "mp_bitset_resize failed to grow");
+    expectf(mp_bitset_count(&c) == 70 && mp_bitset_find_next(&c, 70) == 200,
+            "grow: %zu",
+            mp_bitset_count(&c));
+
+    mp_bitset_destroy(&c);
+    mp_bitset_destroy(&b);
+    mp_bitset_destroy(&a);
+    mp_arena_destroy(&arena);
+}
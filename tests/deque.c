@@ -0,0 +1,139 @@
+#include "test.h"
+
+#include <pthread.h>
+
+mp_deque_create(Deque_Int, int);
+mp_spsc_create(Queue_Int, int);
+
+#define QUEUE_ITEMS 1000000
+
+void *producer(void *arg) {
+    Queue_Int *queue = arg;
+    int        batch[7];
+    for (int i = 0; i < QUEUE_ITEMS;) {
+        if (i % 3 == 0) {
+            if (Queue_Int_push(queue, i)) ++i;
+        } else {
+            int amount = 0;
+            for (; amount < 7 && i + amount < QUEUE_ITEMS; ++amount)
+                batch[amount] = i + amount;
+            i += Queue_Int_push_many(queue, batch, amount);
+        }
+    }
+    return NULL;
+}
+
+void print_deque(Deque_Int *deque) {
+    printf("{");
+    for (size_t i = 0; i < deque->len; ++i) {
+        if (i > 0) printf(", ");
+        printf("%d", mp_deque_get(deque, i));
+    }
+    printf("}\n");
+}
+
+int main(void) {
+    mp_Arena arena;
+    mp_arena_init(&arena);
+    mp_Allocator alloc = mp_arena_allocator(&arena);
+
+    Deque_Int deque;
+    mp_deque_init(&deque, &alloc);
+    for (int i = 0; i < 5; ++i) {
+        mp_deque_push_back(&deque, i);
+        mp_deque_push_front(&deque, -i - 1);
+    }
+    printf("mp_deque_push_back/front: ");
+    print_deque(&deque);
+    expectf(deque.len == 10 && deque.cap == MP_DEQUE_INIT_CAPACITY &&
+                mp_deque_first(&deque) == -5 && mp_deque_last(&deque) == 4,
+            "1(%zu;%zu)",
+            deque.len,
+            deque.cap);
+    expectf(mp_deque_first_len(&deque) == 5, "mp_deque_first_len: %zu", mp_deque_first_len(&deque));
+
+    int front = mp_deque_pop_front(&deque);
+    int back  = mp_deque_pop_back(&deque);
+    expectf(front == -5 && back == 4 && deque.len == 8,
+            "mp_deque_pop_front/back: %d %d",
+            front,
+            back);
+
+    int many_ints[100];
+    for (int i = 0; i < 100; ++i)
+        many_ints[i] = 100 + i;
+    mp_deque_push_back_many(&deque, many_ints, 100);
+    expectf(deque.len == 108 && deque.cap == MP_DEQUE_INIT_CAPACITY * 2 && deque.head == 0,
+            "mp_deque_push_back_many: 1(%zu;%zu)",
+            deque.len,
+            deque.cap);
+
+    int popped[8];
+    mp_deque_pop_front_many(&deque, popped, 8);
+    expectf(popped[0] == -4 && popped[3] == -1 && popped[4] == 0 && popped[7] == 3,
+            "mp_deque_pop_front_many: %d %d %d %d",
+            popped[0],
+            popped[3],
+            popped[4],
+            popped[7]);
+
+    // Wrap around the end of the buffer
+    mp_deque_pop_front_many(&deque, many_ints, 90);
+    mp_deque_push_back_many(&deque, many_ints, 100);
+    size_t first = mp_deque_first_len(&deque);
+    expectf(first < deque.len && deque.len == 110, "wrapped: %zu of %zu", first, deque.len);
+    for (size_t i = 0; i < deque.len; ++i) {
+        int expected = i < 10 ? 190 + (int) i : 100 + (int) i - 10;
+        expectf(mp_deque_get(&deque, i) == expected, "wrapped item %zu", i);
+    }
+    // The two segments cover the deque in order
+    expects(deque.data[deque.head] == 190 && deque.data[0] == mp_deque_get(&deque, first),
+            "segments");
+
+    mp_deque_consume(&deque, 10);
+    expectf(mp_deque_first(&deque) == 100, "mp_deque_consume: %d", mp_deque_first(&deque));
+
+    // Arguments named like the temporaries inside the macros
+    size_t cap = 1000;
+    mp_deque_reserve(&deque, cap);
+    expectf(deque.cap == 1024 && mp_deque_first(&deque) == 100,
+            "mp_deque_reserve: %zu",
+            deque.cap);
+    mp_deque_pop_front_many(&deque, many_ints, first);
+    mp_deque_push_back_many(&deque, many_ints, first);
+    expectf(deque.len == 100 && mp_deque_last(&deque) == many_ints[first - 1],
+            "mp_deque_*_many with first: %zu",
+            deque.len);
+
+    mp_deque_clear(&deque);
+    expects(deque.len == 0, "mp_deque_clear");
+    mp_deque_destroy(&deque);
+
+    Queue_Int queue;
+    Queue_Int_init(&queue, &alloc, 1000);
+    expectf(queue.cap == 1024, "Queue_Int_init: %zu", queue.cap);
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, producer, &queue);
+    int expected = 0, buf[5];
+    while (expected < QUEUE_ITEMS) {
+        int item;
+        if (expected % 2 == 0) {
+            if (!Queue_Int_pop(&queue, &item)) continue;
+            expectf(item == expected, "Queue_Int_pop: %d, expected %d", item, expected);
+            ++expected;
+        } else {
+            size_t amount = Queue_Int_pop_many(&queue, buf, 5);
+            for (size_t i = 0; i < amount; ++i, ++expected)
+                expectf(buf[i] == expected,
+                        "Queue_Int_pop_many: %d, expected %d",
+                        buf[i],
+                        expected);
+        }
+    }
+    pthread_join(thread, NULL);
+    expects(!Queue_Int_pop(&queue, &expected), "queue should be empty");
+    Queue_Int_destroy(&queue);
+
+    mp_arena_destroy(&arena);
+}
@@ -0,0 +1,139 @@
+#include "test.h"
+
+#define BINARY_FILE "file_test.bin"
+
+int main(void) {
+    mp_Arena arena;
+    mp_arena_init(&arena);
+    mp_Allocator alloc = mp_arena_allocator(&arena);
+
+    mp_String source;
+    expects(mp_read_entire_file(&alloc, &source, "file.c"), "mp_read_entire_file failed");
+    expectf(source.len > 0 && source.cstr[source.len] == '\0' && strstr(source.cstr, "BINARY_FILE"),
+            "mp_read_entire_file: %zu",
+            source.len);
+
+    // Binary content with null bytes
+    char binary[300];
+    for (size_t i = 0; i < sizeof(binary); ++i)
+        binary[i] = (char) (i * 7);
+    FILE *file = fopen(BINARY_FILE, "wb");
+    expects(file != NULL, "failed to create " BINARY_FILE);
+    fwrite(binary, 1, sizeof(binary), file);
+    fclose(file);
+
+    mp_String content;
+    expects(mp_read_entire_file(&alloc, &content, BINARY_FILE), "mp_read_entire_file failed");
+    expectf(content.len == sizeof(binary) && memcmp(content.cstr, binary, sizeof(binary)) == 0,
+            "mp_read_entire_file (binary): %zu",
+            content.len);
+
+    expects(!mp_read_entire_file(&alloc, &content, "does/not/exist"),
+            "mp_read_entire_file should fail on missing files");
+
+#ifdef MEMPLUS_POSIX
+    mp_Slice map;
+    expects(mp_map_file(&map, BINARY_FILE, MP_MAP_SEQUENTIAL | MP_MAP_WILLNEED),
+            "mp_map_file failed");
+    expectf(map.len == sizeof(binary) && memcmp(map.ptr, binary, sizeof(binary)) == 0,
+            "mp_map_file: %zu",
+            map.len);
+    mp_unmap_file(&map);
+    expects(map.ptr == NULL && map.len == 0, "mp_unmap_file");
+
+    file = fopen(BINARY_FILE, "wb");
+    fclose(file);
+    expects(mp_map_file(&map, BINARY_FILE, 0) && map.len == 0, "mp_map_file (empty)");
+    mp_unmap_file(&map);
+    expects(mp_read_entire_file(&alloc, &content, BINARY_FILE) && content.len == 0 &&
+                content.cstr[0] == '\0',
+            "mp_read_entire_file (empty)");
+
+    expects(!mp_map_file(&map, "does/not/exist", 0), "mp_map_file should fail on missing files");
+#endif
+
+    // Records straddling the end of a tiny buffer and a record larger than the buffer
+    const char *lines[] = { "first", "", "a somewhat longer line than the buffer", "crlf", "last" };
+    file                = fopen(BINARY_FILE, "wb");
+    fprintf(file, "%s\n%s\n%s\n%s\r\n%s", lines[0], lines[1], lines[2], lines[3], lines[4]);
+    fclose(file);
+
+    mp_FileReader reader;
+    expects(mp_file_reader_open(&reader, &alloc, BINARY_FILE, 8), "mp_file_reader_open failed");
+    mp_Slice line;
+    size_t   count = 0;
+    while (mp_file_reader_next_line(&reader, &line)) {
+        expectf(count < 5 && line.len == strlen(lines[count]) &&
+                    memcmp(line.ptr, lines[count], line.len) == 0,
+                "mp_file_reader_next_line: line %zu is %.*s",
+                count,
+                (int) line.len,
+                line.ptr);
+        ++count;
+    }
+    expectf(count == 5 && !reader.error, "mp_file_reader_next_line: %zu lines", count);
+    mp_file_reader_close(&reader);
+
+    // Reading a stream that is already open, with the default buffer size
+    file = fopen(BINARY_FILE, "rb");
+    expects(mp_file_reader_init(&reader, &alloc, file, 0), "mp_file_reader_init failed");
+    mp_Slice record;
+    count = 0;
+    while (mp_file_reader_next(&reader, 'e', &record))
+        ++count;
+    expectf(count == 6, "mp_file_reader_next: %zu records", count);
+    mp_file_reader_close(&reader);
+    fclose(file);
+
+    // A stream that fails to read gives no record, not even an empty partial one
+    file = fopen(BINARY_FILE, "wb");
+    expects(mp_file_reader_init(&reader, &alloc, file, 8), "mp_file_reader_init failed");
+    expects(!mp_file_reader_next(&reader, '\n', &record) && reader.error,
+            "mp_file_reader_next: read error was not reported");
+    mp_file_reader_close(&reader);
+    fclose(file);
+
+    remove(BINARY_FILE);
+
+#if defined(MEMPLUS_POSIX) && !defined(MEMPLUS_NO_THREADS)
+    // Batch loading a generated set of files, one of them missing
+    enum { FILES = 64 };
+    char        paths[FILES][32];
+    const char *path_ptrs[FILES];
+    for (int i = 0; i < FILES; ++i) {
+        snprintf(paths[i], sizeof(paths[i]), "file_test_%d.txt", i);
+        path_ptrs[i] = paths[i];
+        if (i == 13) continue;
+        file = fopen(paths[i], "wb");
+        fprintf(file, "file %d", i);
+        fclose(file);
+    }
+    mp_String contents[FILES];
+    int       errors[FILES];
+    size_t    failed = mp_read_files(&alloc, path_ptrs, FILES, contents, errors, 4);
+    expectf(failed == 1 && errors[13] == ENOENT && contents[13].cstr == NULL,
+            "mp_read_files: %zu failed",
+            failed);
+    // A single worker reads with the given allocator without locking
+    mp_String single[FILES];
+    int       single_errors[FILES];
+    failed = mp_read_files(&alloc, path_ptrs, FILES, single, single_errors, 1);
+    expectf(failed == 1 && single_errors[13] == ENOENT, "mp_read_files: %zu failed", failed);
+    for (int i = 0; i < FILES; ++i) {
+        if (i == 13) continue;
+        char expected[32];
+        snprintf(expected, sizeof(expected), "file %d", i);
+        expectf(errors[i] == 0 && strcmp(contents[i].cstr, expected) == 0,
+                "mp_read_files: file %d is %s",
+                i,
+                contents[i].cstr);
+        expectf(single_errors[i] == 0 && strcmp(single[i].cstr, expected) == 0,
+                "mp_read_files: file %d is %s with one thread",
+                i,
+                single[i].cstr);
+        remove(paths[i]);
+    }
+#endif
+
+    mp_arena_destroy(&arena);
+}
@@ -0,0 +1,97 @@
+#include "test.h"
+
+#include <pthread.h>
+
+#define THREADS 4
+#define WORDS   10000
+
+mp_SharedInterner shared;
+mp_String         shared_results[THREADS][WORDS];
+
+void *intern_words(void *arg) {
+    size_t id = (size_t) arg;
+    char   buf[32];
+    for (size_t i = 0; i < WORDS; ++i) {
+        // Every thread interns the same words in a different order
+        size_t word = (i * 7919 + id * 104729) % WORDS;
+        int    len  = snprintf(buf, sizeof(buf), "word%zu", word);
+        shared_results[id][word] = mp_shared_interner_intern(&shared, mp_slice(buf, len));
+    }
+    return NULL;
+}
+
+int main(void) {
+    mp_Allocator heap = mp_heap_allocator();
+
+    mp_Interner interner;
+    mp_interner_init(&interner, &heap);
+
+    mp_String a = mp_interner_intern(&interner, mp_slice_from_cstr("hello"));
+    mp_String b = mp_interner_intern(&interner, mp_slice("hello world", 5));
+    mp_String c = mp_interner_intern(&interner, mp_slice_from_cstr("world"));
+    expects(a.cstr == b.cstr && a.cstr != c.cstr, "interned strings should compare by pointer");
+    expectf(a.len == 5 && strcmp(a.cstr, "hello") == 0 && interner.len == 2,
+            "mp_interner_intern: %s (%zu unique)",
+            a.cstr,
+            interner.len);
+
+    mp_String empty = mp_interner_intern(&interner, mp_slice("", 0));
+    expects(empty.cstr != NULL && empty.len == 0 && empty.cstr[0] == '\0', "empty string");
+
+    mp_Slice  words[] = { mp_slice_from_cstr("world"), mp_slice_from_cstr("foo") };
+    mp_String interned[2];
+    expects(mp_interner_intern_many(&interner, words, 2, interned), "mp_interner_intern_many");
+    expects(interned[0].cstr == c.cstr && interned[1].len == 3, "mp_interner_intern_many");
+
+    uint64_t  hash = mp_hash("foo", 3);
+    mp_String foo  = mp_interner_intern_hashed(&interner, mp_slice("foo", 3), hash);
+    expects(foo.cstr == interned[1].cstr, "mp_interner_intern_hashed");
+
+    expects(mp_interner_find(&interner, mp_slice_from_cstr("hello")).cstr == a.cstr,
+            "mp_interner_find");
+    expects(mp_interner_find(&interner, mp_slice_from_cstr("nope")).cstr == NULL,
+            "mp_interner_find");
+
+    // Grow the index past its initial capacity
+    char buf[32];
+    for (int i = 0; i < 1000; ++i) {
+        int len = snprintf(buf, sizeof(buf), "%d", i);
+        mp_interner_intern(&interner, mp_slice(buf, len));
+    }
+    expectf(interner.len == 1004 && interner.cap >= 2048,
+            "grow: %zu;%zu",
+            interner.len,
+            interner.cap);
+    expects(mp_interner_find(&interner, mp_slice_from_cstr("hello")).cstr == a.cstr,
+            "strings stay put after growing");
+    expects(mp_interner_find(&interner, mp_slice_from_cstr("999")).len == 3, "mp_interner_find");
+
+    // Fill the index up to its load limit, strings that are already interned must not grow it
+    for (int i = 1000; (interner.len + 1) * 4 <= interner.cap * 3; ++i) {
+        int len = snprintf(buf, sizeof(buf), "%d", i);
+        mp_interner_intern(&interner, mp_slice(buf, len));
+    }
+    size_t cap = interner.cap;
+    expects(mp_interner_intern(&interner, mp_slice_from_cstr("hello")).cstr == a.cstr &&
+                interner.cap == cap,
+            "interning an existing string grew the index");
+
+    mp_interner_destroy(&interner);
+
+    mp_shared_interner_init(&shared, &heap);
+    pthread_t threads[THREADS];
+    for (size_t i = 0; i < THREADS; ++i)
+        pthread_create(&threads[i], NULL, intern_words, (void *) i);
+    for (size_t i = 0; i < THREADS; ++i)
+        pthread_join(threads[i], NULL);
+    size_t unique = 0;
+    for (size_t i = 0; i < MP_INTERNER_SHARDS; ++i)
+        unique += shared.shards[i].interner.len;
+    expectf(unique == WORDS, "mp_shared_interner: %zu unique", unique);
+    for (size_t word = 0; word < WORDS; ++word)
+        for (size_t id = 1; id < THREADS; ++id)
+            expectf(shared_results[id][word].cstr == shared_results[0][word].cstr,
+                    "word%zu interned twice",
+                    word);
+    mp_shared_interner_destroy(&shared);
+}
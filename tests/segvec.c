@@ -0,0 +1,59 @@
+#include "test.h"
+
+mp_segvec_create(SegVector_Int, int);
+
+int main(void) {
+    mp_Arena arena;
+    mp_arena_init(&arena);
+    mp_Allocator alloc = mp_arena_allocator(&arena);
+
+    SegVector_Int vec;
+    mp_segvec_init(&vec, &alloc);
+    mp_segvec_append(&vec, 0);
+    int *first = &mp_segvec_get(&vec, 0);
+    for (int i = 1; i < 1000; ++i)
+        mp_segvec_append(&vec, i);
+    expectf(vec.len == 1000 && vec.chunks_len == 5 && vec.cap == 960 + 1024,
+            "1(%zu;%zu) %zu chunks",
+            vec.len,
+            vec.cap,
+            vec.chunks_len);
+    expects(first == &mp_segvec_get(&vec, 0), "address of the first item changed");
+    for (size_t i = 0; i < vec.len; ++i)
+        expectf(mp_segvec_get(&vec, i) == (int) i,
+                "mp_segvec_get %zu: %d",
+                i,
+                mp_segvec_get(&vec, i));
+
+    int many_ints[3000];
+    for (int i = 0; i < 3000; ++i)
+        many_ints[i] = 1000 + i;
+    mp_segvec_append_many(&vec, many_ints, 3000);
+    expectf(vec.len == 4000, "mp_segvec_append_many: 1(%zu;%zu)", vec.len, vec.cap);
+
+    size_t index = 0;
+    for (size_t k = 0; k < vec.chunks_len; ++k) {
+        size_t len = mp_segvec_chunk_len(&vec, k);
+        for (size_t j = 0; j < len; ++j, ++index)
+            expectf(vec.chunks[k][j] == (int) index,
+                    "chunk %zu item %zu: %d",
+                    k,
+                    j,
+                    vec.chunks[k][j]);
+    }
+    expectf(index == vec.len, "chunk iteration visited %zu items", index);
+
+    int last = mp_segvec_pop(&vec);
+    expectf(last == 3999 && vec.len == 3999, "mp_segvec_pop: %d (%zu)", last, vec.len);
+
+    size_t cap = vec.cap;
+    mp_segvec_clear(&vec);
+    mp_segvec_append(&vec, 69);
+    expectf(vec.cap == cap && mp_segvec_get(&vec, 0) == 69 && first == &mp_segvec_get(&vec, 0),
+            "mp_segvec_clear: 1(%zu;%zu)",
+            vec.len,
+            vec.cap);
+
+    mp_segvec_destroy(&vec);
+    mp_arena_destroy(&arena);
+}
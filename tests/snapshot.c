@@ -0,0 +1,100 @@
+#include "test.h"
+
+#define SNAPSHOT_FILE "snapshot_test.bin"
+#define ENTRIES       1000
+
+typedef struct {
+    mp_RelString key;
+    int          value;
+} Entry;
+
+mp_relvector_create(Entries, Entry);
+mp_relvector_create(Ints, int);
+
+typedef struct {
+    mp_RelString title;
+    Entries      entries;
+    Ints         primes;
+} Root;
+
+void check(const Root *root) {
+    mp_String title = mp_relstring_get(&root->title);
+    expectf(title.len == 10 && strcmp(title.cstr, "dictionary") == 0, "title: %s", title.cstr);
+    expectf(root->entries.len == ENTRIES, "entries: %zu", root->entries.len);
+    const Entry *entries = Entries_data(&root->entries);
+    char         key[32];
+    for (int i = 0; i < ENTRIES; ++i) {
+        snprintf(key, sizeof(key), "key_%d", i);
+        mp_String entry_key = mp_relstring_get(&entries[i].key);
+        expectf(strcmp(entry_key.cstr, key) == 0 && entry_key.len == strlen(key) &&
+                    entries[i].value == i * i,
+                "entry %d: %s = %d",
+                i,
+                entry_key.cstr,
+                entries[i].value);
+    }
+    expectf(root->primes.len == 5 && Ints_get(&root->primes, 4) == 11,
+            "primes: %zu",
+            root->primes.len);
+}
+
+int main(void) {
+    mp_SArena arena;
+    mp_sarena_init(&arena, 16 * 1024);
+    mp_Allocator alloc = mp_sarena_allocator(&arena);
+
+    // The root is the first allocation
+    Root *root = mp_create(&alloc, Root);
+    expects(mp_relstring_init(&root->title, &alloc, mp_slice_from_cstr("dictionary")),
+            "mp_relstring_init failed to allocate");
+    expects(Entries_init(&root->entries, &alloc, NULL, ENTRIES), "Entries_init failed to allocate");
+    Entry *entries = Entries_data(&root->entries);
+    char   key[32];
+    for (int i = 0; i < ENTRIES; ++i) {
+        snprintf(key, sizeof(key), "key_%d", i);
+        expects(mp_relstring_init(&entries[i].key, &alloc, mp_slice_from_cstr(key)),
+                "mp_relstring_init failed to allocate");
+        entries[i].value = i * i;
+    }
+    int primes[] = { 2, 3, 5, 7, 11 };
+    expects(Ints_init(&root->primes, &alloc, primes, 5), "Ints_init failed to allocate");
+    check(root);
+
+    // Moving the memory keeps the relative pointers valid
+    size_t     size  = arena.len * sizeof(uintptr_t);
+    uintptr_t *moved = malloc(size);
+    memcpy(moved, arena.buf, size);
+    memset(arena.buf, 0, size);
+    check((const Root *) moved);
+    memcpy(arena.buf, moved, size);
+    free(moved);
+
+    expects(mp_snapshot_save(&arena, SNAPSHOT_FILE), "mp_snapshot_save failed");
+    mp_sarena_destroy(&arena);
+
+    mp_Snapshot snapshot;
+    expects(mp_snapshot_load(&snapshot, SNAPSHOT_FILE, true), "mp_snapshot_load failed");
+    expectf(snapshot.len == size, "mp_snapshot_load: %zu bytes", snapshot.len);
+    expectf((uintptr_t) mp_snapshot_root(&snapshot, Root) % MP_SNAPSHOT_ALIGN == 0,
+            "mp_snapshot_root: misaligned at %p",
+            (void *) mp_snapshot_root(&snapshot, Root));
+    check(mp_snapshot_root(&snapshot, Root));
+    mp_snapshot_unload(&snapshot);
+
+    // A corrupted snapshot only fails to load if it is verified
+    FILE *file = fopen(SNAPSHOT_FILE, "r+b");
+    fseek(file, sizeof(mp_SnapshotHeader) + size - 1, SEEK_SET);
+    fputc('!', file);
+    fclose(file);
+    expects(mp_snapshot_load(&snapshot, SNAPSHOT_FILE, false), "mp_snapshot_load failed");
+    mp_snapshot_unload(&snapshot);
+    expects(!mp_snapshot_load(&snapshot, SNAPSHOT_FILE, true) && errno == EINVAL,
+            "mp_snapshot_load should detect the corruption");
+
+    file = fopen(SNAPSHOT_FILE, "wb");
+    fputs("not a snapshot", file);
+    fclose(file);
+    expects(!mp_snapshot_load(&snapshot, SNAPSHOT_FILE, false) && errno == EINVAL,
+            "mp_snapshot_load should reject other files");
+    remove(SNAPSHOT_FILE);
+}
@@ -0,0 +1,82 @@
+#include "test.h"
+
+#define PARTICLE_FIELDS(X) X(float, x) X(float, y) X(uint8_t, alive) X(uint64_t, id)
+
+mp_soa_create(Particles, PARTICLE_FIELDS);
+
+void print_particles(Particles *particles) {
+    printf("{");
+    for (size_t i = 0; i < particles->len; ++i) {
+        if (i > 0) printf(", ");
+        printf("%lu", (unsigned long) particles->id[i]);
+    }
+    printf("}\n");
+}
+
+int main(void) {
+    mp_Arena arena;
+    mp_arena_init(&arena);
+    mp_Allocator alloc = mp_arena_allocator(&arena);
+
+    Particles particles;
+    Particles_init(&particles, &alloc);
+    for (int i = 0; i < 100; ++i) {
+        bool ok = Particles_append(
+            &particles, (Particles_Item){ .x = i, .y = -i, .alive = i % 2, .id = i });
+        expects(ok, "Particles_append failed to allocate");
+    }
+    expectf(particles.len == 100 && particles.cap == MP_VECTOR_INIT_CAPACITY * 2,
+            "1(%zu;%zu)",
+            particles.len,
+            particles.cap);
+    expects((uintptr_t) particles.x % MP_SOA_ALIGN == 0 &&
+                (uintptr_t) particles.id % MP_SOA_ALIGN == 0,
+            "columns are not aligned");
+
+    float sum = 0;
+    for (size_t i = 0; i < particles.len; ++i)
+        sum += particles.x[i];
+    expectf(sum == 4950, "sum of x: %f", sum);
+
+    Particles_Item item = Particles_get(&particles, 42);
+    expectf(item.x == 42 && item.y == -42 && item.alive == 0 && item.id == 42,
+            "Particles_get: %f %f %d %lu",
+            item.x,
+            item.y,
+            item.alive,
+            (unsigned long) item.id);
+
+    Particles_erase(&particles, 0);
+    Particles_erase(&particles, 0);
+    expectf(particles.len == 98 && particles.id[0] == 2 && particles.x[0] == 2,
+            "Particles_erase: %zu %lu",
+            particles.len,
+            (unsigned long) particles.id[0]);
+
+    Particles_insert(&particles, 1, (Particles_Item){ .x = 777, .y = 0, .alive = 1, .id = 777 });
+    expectf(particles.id[1] == 777 && particles.x[1] == 777 && particles.id[2] == 3,
+            "Particles_insert: %lu %lu",
+            (unsigned long) particles.id[1],
+            (unsigned long) particles.id[2]);
+
+    Particles_unordered_erase(&particles, 0);
+    item = Particles_pop(&particles);
+    expectf(item.id == 98 && particles.id[0] == 99 && particles.len == 97,
+            "Particles_unordered_erase -> Particles_pop: %lu %lu",
+            (unsigned long) item.id,
+            (unsigned long) particles.id[0]);
+
+    Particles_resize(&particles, 5);
+    printf("Particles_resize 5: ");
+    print_particles(&particles);
+
+    expects(Particles_reserve(&particles, 1000), "Particles_reserve failed to allocate");
+    expectf(particles.cap == 1000 && particles.id[1] == 777 && particles.alive[1] == 1,
+            "Particles_reserve: %zu",
+            particles.cap);
+
+    Particles_destroy(&particles);
+    expects(particles.len == 0 && particles.cap == 0 && particles.x == NULL, "Particles_destroy");
+
+    mp_arena_destroy(&arena);
+}
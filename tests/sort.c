@@ -0,0 +1,117 @@
+#include "test.h"
+
+mp_vector_create(Vector_Int, int);
+mp_vector_create(Vector_U32, uint32_t);
+mp_vector_create(Vector_F64, double);
+
+typedef struct {
+    uint32_t id;
+    int64_t  score;
+} Entry;
+
+#define entry_less(a, b) ((a).score < (b).score)
+
+mp_sort_create(sort_int, int, MP_LESS);
+mp_sort_create(sort_entry, Entry, entry_less);
+
+uint64_t entry_key(const void *item) {
+    return (uint64_t) ((const Entry *) item)->score ^ (UINT64_C(1) << 63);
+}
+
+int main(void) {
+    mp_Arena arena;
+    mp_arena_init(&arena);
+    mp_Allocator alloc = mp_arena_allocator(&arena);
+
+    srand(69);
+
+    Vector_Int ints;
+    mp_vector_init(&ints, &alloc);
+    for (int i = 0; i < 10000; ++i)
+        mp_append(&ints, rand() % 1000 - 500);
+    mp_sort(&ints, sort_int);
+    for (size_t i = 1; i < ints.len; ++i)
+        expectf(mp_get(&ints, i - 1) <= mp_get(&ints, i), "sort_int: %zu", i);
+
+    mp_sort_unique(&ints, sort_int);
+    expectf(ints.len == 1000, "mp_sort_unique: %zu", ints.len);
+    for (size_t i = 1; i < ints.len; ++i)
+        expectf(mp_get(&ints, i - 1) < mp_get(&ints, i), "mp_sort_unique: %zu", i);
+
+    // Already sorted, reversed and constant inputs
+    for (size_t i = 0; i < ints.len; ++i)
+        mp_get(&ints, i) = (int) (ints.len - i);
+    mp_sort(&ints, sort_int);
+    expectf(mp_first(&ints) == 1 && mp_last(&ints) == 1000, "reversed: %d", mp_first(&ints));
+    for (size_t i = 0; i < ints.len; ++i)
+        mp_get(&ints, i) = 7;
+    mp_sort_unique(&ints, sort_int);
+    expectf(ints.len == 1 && mp_first(&ints) == 7, "constant: %zu", ints.len);
+
+    mp_temp_buffer(temp_buf, 64 * 1024);
+    mp_Temp temp;
+    mp_temp_init(&temp, temp_buf);
+    mp_Allocator scratch = mp_temp_allocator(&temp);
+
+    Vector_U32 u32s;
+    mp_vector_init(&u32s, &alloc);
+    for (int i = 0; i < 4096; ++i)
+        mp_append(&u32s, (uint32_t) rand() * 2654435761u);
+    expects(mp_radix_sort(&u32s, u32, &scratch), "mp_radix_sort_u32 failed to allocate");
+    for (size_t i = 1; i < u32s.len; ++i)
+        expectf(mp_get(&u32s, i - 1) <= mp_get(&u32s, i), "mp_radix_sort_u32: %zu", i);
+
+    mp_temp_reset(&temp);
+    Vector_F64 f64s;
+    mp_vector_init(&f64s, &alloc);
+    double doubles[] = { 3.5, -0.25, 1e300, -1e-300, 0.0, -2.0, 42.0, -1e300 };
+    mp_append_many(&f64s, doubles, sizeof(doubles) / sizeof(doubles[0]));
+    expects(mp_radix_sort(&f64s, f64, &scratch), "mp_radix_sort_f64 failed to allocate");
+    printf("mp_radix_sort_f64: {");
+    for (size_t i = 0; i < f64s.len; ++i) {
+        if (i > 0) printf(", ");
+        printf("%g", mp_get(&f64s, i));
+        if (i > 0) expectf(mp_get(&f64s, i - 1) <= mp_get(&f64s, i), "mp_radix_sort_f64: %zu", i);
+    }
+    printf("}\n");
+
+    mp_temp_reset(&temp);
+    float f32s[] = { 1.5f, -0.0f, -3.25f, 1e30f, -1e-30f, 0.5f };
+    expects(mp_radix_sort_f32(f32s, 6, &scratch), "mp_radix_sort_f32 failed to allocate");
+    for (size_t i = 1; i < 6; ++i)
+        expectf(f32s[i - 1] <= f32s[i], "mp_radix_sort_f32: %zu", i);
+
+    mp_temp_reset(&temp);
+    int32_t i32s[] = { 5, -3, INT32_MIN, 0, INT32_MAX, -1 };
+    expects(mp_radix_sort_i32(i32s, 6, &scratch), "mp_radix_sort_i32 failed to allocate");
+    expectf(i32s[0] == INT32_MIN && i32s[1] == -3 && i32s[5] == INT32_MAX,
+            "mp_radix_sort_i32: %d %d %d",
+            i32s[0],
+            i32s[1],
+            i32s[5]);
+
+    // Stability: entries with the same score keep their order
+    mp_temp_reset(&temp);
+    Entry entries[256];
+    for (uint32_t i = 0; i < 256; ++i)
+        entries[i] = (Entry){ i, (int64_t) (rand() % 16) - 8 };
+    expects(mp_radix_sort_key(entries, 256, sizeof(Entry), entry_key, &scratch),
+            "mp_radix_sort_key failed to allocate");
+    for (size_t i = 1; i < 256; ++i) {
+        expectf(entries[i - 1].score < entries[i].score ||
+                    (entries[i - 1].score == entries[i].score && entries[i - 1].id < entries[i].id),
+                "mp_radix_sort_key: %zu",
+                i);
+    }
+    sort_entry(entries, 256);
+    for (size_t i = 1; i < 256; ++i)
+        expectf(entries[i - 1].score <= entries[i].score, "sort_entry: %zu", i);
+
+    mp_temp_buffer(tiny_buf, 16);
+    mp_Temp tiny;
+    mp_temp_init(&tiny, tiny_buf);
+    mp_Allocator tiny_alloc = mp_temp_allocator(&tiny);
+    expects(!mp_radix_sort(&u32s, u32, &tiny_alloc), "mp_radix_sort should fail without scratch");
+
+    mp_arena_destroy(&arena);
+}
@@ -14,5 +14,210 @@ int main(void) {
     mp_String mynewhome = mp_string_dup(&alloc, myhome);
     prnf("My old home is at %p, but now I live at %p", myhome.cstr, mynewhome.cstr);
 
+    mp_StringBuilder builder;
+    mp_string_builder_init(&builder, &alloc);
+    mp_string_builder_append_cstr(&builder, "Hello");
+    mp_string_builder_append_char(&builder, ',');
+    mp_string_builder_append_string(&builder, greeting);
+    mp_string_builder_append(&builder, "!!!", 1);
+    mp_string_builder_append_int(&builder, -42);
+    mp_string_builder_append_char(&builder, ' ');
+    mp_string_builder_append_uint(&builder, 18446744073709551615ull);
+    mp_string_builder_append_char(&builder, ' ');
+    mp_string_builder_append_int(&builder, -9223372036854775807ll - 1);
+    mp_string_builder_appendf(&builder, " %s=%d", "answer", 42);
+    prn(builder.data);
+    mp_String expected = mp_string_newf(&alloc,
+                                        "Hello,%s!-42 18446744073709551615 -9223372036854775808 "
+                                        "answer=42",
+                                        greeting.cstr);
+    expectf(builder.len == expected.len && strcmp(builder.data, expected.cstr) == 0,
+            "mp_string_builder: %s",
+            builder.data);
+
+    mp_String fast = mp_string_newf(&alloc,
+                                    "[%s] %d%% %.*s id=%lld size=%zu hex=%lx %c",
+                                    "request",
+                                    99,
+                                    3,
+                                    "abcdef",
+                                    -1234567890123ll,
+                                    (size_t) 4096,
+                                    0xbeeful,
+                                    'Z');
+    expectf(strcmp(fast.cstr, "[request] 99% abc id=-1234567890123 size=4096 hex=beef Z") == 0,
+            "mp_string_newf: %s",
+            fast.cstr);
+    mp_String signed_size = mp_string_newf(&alloc, "%zd %zd", (size_t) -5, SIZE_MAX / 2);
+    mp_String expected_size = mp_string_newf(&alloc, "-5 %zu", SIZE_MAX / 2);
+    expectf(strcmp(signed_size.cstr, expected_size.cstr) == 0,
+            "mp_string_newf: %s",
+            signed_size.cstr);
+    mp_String fallback = mp_string_newf(&alloc, "%5.2f|%-3d|%s", 3.14159, 7, "end");
+    expectf(strcmp(fallback.cstr, " 3.14|7  |end") == 0, "mp_string_newf: %s", fallback.cstr);
+
+    struct {
+        double      value;
+        const char *expected;
+    } doubles[] = {
+        { 0.0,                      "0"                        },
+        { -1.5,                     "-1.5"                     },
+        { 0.1,                      "0.1"                      },
+        { 0.3,                      "0.3"                      },
+        { 100.0,                    "100"                      },
+        { 1e16,                     "10000000000000000"        },
+        { 1e17,                     "1e+17"                    },
+        { 1e22,                     "1e+22"                    },
+        { 1.2345e-5,                "1.2345e-05"               },
+        { 0.0001,                   "0.0001"                   },
+        { 123.456,                  "123.456"                  },
+        { 5e-324,                   "5e-324"                   },
+        { 1.7976931348623157e308,   "1.7976931348623157e+308"  },
+        { -2.2250738585072014e-308, "-2.2250738585072014e-308" },
+    };
+    char buf[MP_FORMAT_DOUBLE_SIZE + 1];
+    for (size_t i = 0; i < sizeof(doubles) / sizeof(doubles[0]); ++i) {
+        size_t len = mp_format_double(buf, doubles[i].value);
+        buf[len]   = '\0';
+        expectf(strcmp(buf, doubles[i].expected) == 0,
+                "mp_format_double: %s instead of %s",
+                buf,
+                doubles[i].expected);
+    }
+    // Random doubles read back exactly
+    srand(420);
+    for (int i = 0; i < 100000; ++i) {
+        uint64_t bits = (uint64_t) rand() << 42 ^ (uint64_t) rand() << 21 ^ (uint64_t) rand();
+        double   value;
+        memcpy(&value, &bits, sizeof(value));
+        if (value != value) continue;
+        size_t len = mp_format_double(buf, value);
+        buf[len]   = '\0';
+        expectf(strtod(buf, NULL) == value, "mp_format_double: %s is not %.17g", buf, value);
+    }
+
+    mp_string_builder_clear(&builder);
+    mp_string_builder_append_double(&builder, 0.5);
+    mp_string_builder_append_char(&builder, ' ');
+    mp_string_builder_append_double(&builder, -1.0 / 3.0);
+    expectf(strcmp(builder.data, "0.5 -0.3333333333333333") == 0,
+            "mp_string_builder_append_double: %s",
+            builder.data);
+
+    // Growing the last allocation of an arena happens in place
+    mp_string_builder_clear(&builder);
+    mp_string_builder_reserve(&builder, 256);
+    char *data = builder.data;
+    for (int i = 0; i < 1000; ++i)
+        mp_string_builder_appendf(&builder, "%d,", i);
+    expectf(builder.data == data && builder.cap > 1000 && builder.len == strlen(builder.data),
+            "mp_string_builder_appendf: %zu;%zu",
+            builder.len,
+            builder.cap);
+
+    size_t    len   = builder.len;
+    mp_String built = mp_string_builder_to_string(&builder);
+    expectf(built.cstr == data && built.len == len && builder.data == NULL,
+            "mp_string_builder_to_string: %zu",
+            built.len);
+
+    mp_string_builder_destroy(&builder);
+
+    mp_Slice line    = mp_slice_from_cstr("  key = value,,last \n");
+    mp_Slice trimmed = mp_slice_trim(line);
+    expectf(trimmed.len == 17 && trimmed.ptr == line.ptr + 2, "mp_slice_trim: %zu", trimmed.len);
+    mp_Slice sub = mp_slice_sub(trimmed, 6, 100);
+    expectf(sub.len == 11 && strncmp(sub.ptr, "value,,last", 11) == 0,
+            "mp_slice_sub: %zu",
+            sub.len);
+
+    const char *fields[] = { "value", "", "last" };
+    mp_Slice    rest  = sub, field;
+    size_t      count = 0;
+    while (mp_slice_split_next(&rest, ',', &field)) {
+        expectf(count < 3 && field.len == strlen(fields[count]) &&
+                    strncmp(field.ptr, fields[count], field.len) == 0,
+                "mp_slice_split_next: field %zu is %.*s",
+                count,
+                (int) field.len,
+                field.ptr);
+        ++count;
+    }
+    expectf(count == 3, "mp_slice_split_next: %zu fields", count);
+
+    const char *tokens[] = { "key", "value", "last" };
+    mp_Slice    token;
+    rest  = line;
+    count = 0;
+    while (mp_slice_tokenize_next(&rest, " =,\n", &token)) {
+        expectf(count < 3 && token.len == strlen(tokens[count]) &&
+                    strncmp(token.ptr, tokens[count], token.len) == 0,
+                "mp_slice_tokenize_next: token %zu is %.*s",
+                count,
+                (int) token.len,
+                token.ptr);
+        ++count;
+    }
+    expectf(count == 3, "mp_slice_tokenize_next: %zu tokens", count);
+
+    mp_String value = mp_string_from_slice(&alloc, mp_slice_sub(sub, 0, 5));
+    expectf(value.len == 5 && strcmp(value.cstr, "value") == 0,
+            "mp_string_from_slice: %s",
+            value.cstr);
+    mp_String value_dup = mp_string_dup(&alloc, value);
+    expectf(value_dup.len == 5 && strcmp(value_dup.cstr, "value") == 0,
+            "mp_string_dup: %s",
+            value_dup.cstr);
+
+    expects(mp_slice_eq(mp_slice_from_string(value), mp_slice_from_cstr("value")) &&
+                mp_string_eq(value, value_dup) && !mp_string_eq(value, mp_string_new(&alloc, "v")),
+            "mp_string_eq");
+    expects(mp_slice_cmp(mp_slice_from_cstr("abc"), mp_slice_from_cstr("abd")) < 0 &&
+                mp_slice_cmp(mp_slice_from_cstr("abc"), mp_slice_from_cstr("ab")) > 0 &&
+                mp_string_cmp(value, value_dup) == 0,
+            "mp_slice_cmp");
+
+    // Compare the search against strstr and strcspn on random haystacks
+    char haystack[1000];
+    srand(69);
+    for (int round = 0; round < 200; ++round) {
+        size_t hay_len = rand() % (sizeof(haystack) - 1);
+        for (size_t i = 0; i < hay_len; ++i)
+            haystack[i] = 'a' + rand() % 3;
+        haystack[hay_len] = '\0';
+        char   needle[16];
+        size_t needle_len = rand() % (sizeof(needle) - 1);
+        for (size_t i = 0; i < needle_len; ++i)
+            needle[i] = 'a' + rand() % 3;
+        needle[needle_len] = '\0';
+
+        const char *expected = strstr(haystack, needle);
+        size_t      found    = mp_slice_find(mp_slice_from_cstr(haystack),
+                                             mp_slice_from_cstr(needle));
+        expectf(found == (expected ? (size_t) (expected - haystack) : MP_NPOS),
+                "mp_slice_find: \"%s\" in round %d",
+                needle,
+                round);
+    }
+    mp_Slice text = mp_slice_from_cstr("the quick brown fox jumps over the lazy dog");
+    expectf(mp_slice_find_any(text, "zyx") == 18,
+            "mp_slice_find_any: %zu",
+            mp_slice_find_any(text, "zyx"));
+    expectf(mp_slice_find_any(text, "0123456789z") == 37,
+            "mp_slice_find_any: %zu",
+            mp_slice_find_any(text, "0123456789z"));
+    expects(mp_slice_find_any(text, "!?") == MP_NPOS, "mp_slice_find_any should not match");
+
+    // Hashes depend on every byte and on the length
+    for (size_t i = 0; i < sizeof(haystack); ++i)
+        haystack[i] = (char) i;
+    for (size_t len = 1; len < 200; ++len) {
+        uint64_t hash = mp_hash(haystack, len);
+        expectf(hash != mp_hash(haystack, len - 1), "mp_hash: length %zu", len);
+        haystack[len / 2] ^= 1;
+        expectf(hash != mp_hash(haystack, len), "mp_hash: flipped bit at %zu", len);
+        haystack[len / 2] ^= 1;
+        expectf(hash == mp_hash(haystack, len), "mp_hash: not deterministic at %zu", len);
+    }
     mp_arena_destroy(&arena);
 }
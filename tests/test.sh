@@ -1,6 +1,6 @@
 #!/usr/bin/env bash
 
-TESTS=(allocs string vector)
+TESTS=(allocs string vector sort soa segvec deque bitset interner file snapshot)
 
 cd `dirname $0`
 
@@ -12,7 +12,7 @@ run () {
         echo -ne $WHITE
         echo "|=> $1"
         echo -ne $RESET
-        cc -ggdb -o $1 ${1}.c
+        cc -ggdb -pthread -o $1 ${1}.c
         ./$1
         echo -ne $WHITE
         echo "####################"
@@ -23,10 +23,26 @@ run () {
     fi
 }
 
+# The header must compile in strict ISO C mode
+check_std () {
+    echo -ne $WHITE
+    echo "|=> -std=$1"
+    echo -ne $RESET
+    if ! printf '#define MEMPLUS_IMPLEMENTATION\n#include "../memplus.h"\n' |
+            cc -std=$1 -Wall -Wextra -pedantic -Werror -fsyntax-only -x c -; then
+        echo -e "\033[0;31mmemplus.h does not compile with -std=$1\033[0m"
+    fi
+    echo -ne $WHITE
+    echo "####################"
+    echo -ne $RESET
+}
+
 if [[ $# -gt 0 ]]; then
     run $1
 else
     for test in ${TESTS[@]}; do
         run $test
     done
+    check_std c99
+    check_std c11
 fi